@@ -5,7 +5,15 @@
 #include "../headers/table.h"
 #include "../headers/commands.h"
 #include "../headers/program.h"
+#include "../headers/arena.h"
+#include "../headers/mappedFile.h"
+#include "../headers/scanner.h"
+#include "../headers/journal.h"
+#include "../headers/blockCodec.h"
+#include "../headers/widthHistogram.h"
 #include <iostream>
+#include <cstdio>
+#include <sstream>
 
 
 
@@ -29,6 +37,19 @@ TEST_CASE ("Testing doubleCell")
     REQUIRE (cell.getS_Value() == "12.123");
     REQUIRE (cell.getNum_Value() - 12.123 < 0.000001);
     REQUIRE (cell.getSpacing() == 6);
+
+    //the width is known without formatting the number
+    double values[] = {0, -0.5, 12.123, 1.0 / 3, -99999.9999995, 1234567.125, 1e-7, 2.5e15, -1e300};
+    for (double value : values){
+        REQUIRE (doubleCell::width(value) == doubleCell(value).getSpacing());
+    }
+
+    //the shortest text which is read back as the same number
+    REQUIRE (doubleCell(1.0 / 3).getS_Value() == "0.3333333333333333");
+    REQUIRE (doubleCell(0.1 + 0.2).getS_Value() == "0.30000000000000004");
+    REQUIRE (doubleCell(1e-7).getS_Value() == "0.0000001");
+    REQUIRE (doubleCell(2.5e15).getS_Value() == "2500000000000000");
+    REQUIRE (std::stod(doubleCell(-99999.9999995).getS_Value()) == -99999.9999995);
 }
 
 
@@ -67,6 +88,152 @@ TEST_CASE ("Testing emptyCell")
 
 
 
+TEST_CASE ("Testing CellValue")
+{
+    REQUIRE (sizeof(CellValue) == 16);
+
+    CellValue empty;
+    REQUIRE (empty.type == Type::EMPTY);
+
+    CellValue integer(42);
+    REQUIRE (integer.type == Type::INT);
+    REQUIRE (integer.integer == 42);
+
+    CellValue number(0.5);
+    REQUIRE (number.type == Type::DOUBLE);
+    REQUIRE (number.number == 0.5);
+
+    CellValue string = CellValue::ofString(7);
+    REQUIRE (string.type == Type::STRING);
+    REQUIRE (string.string == 7);
+}
+
+
+
+TEST_CASE ("Testing Arena")
+{
+    Arena arena(1024);
+    REQUIRE (arena.getReserved() == 0);
+
+    char* first = static_cast<char*>(arena.allocate(10, 1));
+    char* second = static_cast<char*>(arena.allocate(10, 1));
+    REQUIRE (static_cast<const void*>(second) == static_cast<const void*>(first + 10)); //compared as addresses, not as strings
+    REQUIRE (arena.getReserved() == 1024);
+
+    double* numbers = arena.allocateArray<double>(4);
+    REQUIRE (reinterpret_cast<uintptr_t>(numbers) % alignof(double) == 0);
+
+    //a big allocation gets a chunk of its own and the current chunk is kept
+    arena.allocate(4096);
+    REQUIRE (arena.getReserved() == 1024 + 4096 + alignof(std::max_align_t));
+    char* third = static_cast<char*>(arena.allocate(1, 1));
+    REQUIRE (static_cast<const void*>(third) == static_cast<const void*>(numbers + 4));
+}
+
+
+
+TEST_CASE ("Testing Scanner")
+{
+    std::string data("1,\"a\\\"b\",2\n");
+    REQUIRE (Scanner::scan(data.data(), data.size(), ',') == ((uint64_t(1) << 1) | (uint64_t(1) << 8)));
+    REQUIRE (Scanner::scan(data.data(), data.size(), '"') == ((uint64_t(1) << 2) | (uint64_t(1) << 5) | (uint64_t(1) << 7)));
+    REQUIRE (Scanner::scan(data.data(), data.size(), '\\') == (uint64_t(1) << 4));
+    REQUIRE (Scanner::scan(data.data(), data.size(), '\n') == (uint64_t(1) << 10));
+
+    //positions in several blocks
+    std::string wide(200, 'x');
+    wide[0] = wide[63] = wide[64] = wide[130] = wide[199] = ',';
+    Scanner scanner(wide, ',');
+    REQUIRE (scanner.next() == 0);
+    REQUIRE (scanner.next() == 63);
+    REQUIRE (scanner.next() == 64);
+    REQUIRE (scanner.next() == 130);
+    REQUIRE (scanner.next() == 199);
+    REQUIRE (scanner.next() == 200);
+    REQUIRE (scanner.next() == 200);
+
+    Scanner empty(std::string_view(), ',');
+    REQUIRE (empty.next() == 0);
+}
+
+
+
+TEST_CASE ("Testing BlockCodec")
+{
+    //repetitive, random-looking and short data, and matches which overlap what they copy
+    std::string repetitive;
+    for (size_t i=0; i<5000; ++i){
+        repetitive += std::to_string(i % 70) + ",\"same text\"\n";
+    }
+    std::string noise;
+    for (size_t i=0; i<3000; ++i){
+        noise.push_back(char((i * 7919 + (i >> 3) * 104729) % 251));
+    }
+    std::string samples[] = {repetitive, noise, "", "abc", std::string(1000, 'z'), "abcdefabcdefabcdefabcdef"};
+
+    for (const std::string& sample : samples){
+        std::string compressed(BlockCodec::bound(sample.size()), '\0');
+        compressed.resize(BlockCodec::compress(sample.data(), sample.size(), &compressed[0]));
+        std::string data(sample.size(), '\0');
+        BlockCodec::decompress(compressed.data(), compressed.size(), &data[0], data.size());
+        REQUIRE (data == sample);
+    }
+
+    std::string compressed(BlockCodec::bound(repetitive.size()), '\0');
+    compressed.resize(BlockCodec::compress(repetitive.data(), repetitive.size(), &compressed[0]));
+    REQUIRE (compressed.size() < repetitive.size() / 10);
+
+    //the blocks of a file are decompressed on several threads
+    std::string file;
+    BlockCodec::writeHeader(file);
+    for (size_t i=0; i<repetitive.size(); i += 1000){
+        BlockCodec::writeBlock(repetitive.data() + i, std::min<size_t>(1000, repetitive.size() - i), file);
+    }
+    BlockCodec::writeBlock(noise.data(), noise.size(), file);
+    BlockCodec::writeEnd(file);
+    REQUIRE (BlockCodec::isCompressed(file));
+    REQUIRE (!BlockCodec::isCompressed(repetitive));
+    REQUIRE (BlockCodec::decompressFile(file, 4) == repetitive + noise);
+
+    file.resize(file.size() - 9);
+    REQUIRE_THROWS_WITH (BlockCodec::decompressFile(file), "Error: the file is damaged");
+    std::string data(repetitive.size(), '\0');
+    REQUIRE_THROWS (BlockCodec::decompress(compressed.data(), compressed.size() - 3, &data[0], data.size()));
+}
+
+
+
+TEST_CASE ("Testing WidthHistogram")
+{
+    WidthHistogram widths;
+    REQUIRE (widths.max() == 0);
+
+    widths.add(3);
+    widths.add(7);
+    widths.add(7);
+    widths.add(0);
+    REQUIRE (widths.max() == 7);
+
+    //the widest width is kept while a cell has it
+    widths.remove(7);
+    REQUIRE (widths.max() == 7);
+    widths.remove(7);
+    REQUIRE (widths.max() == 3);
+
+    //very wide cells are counted too
+    widths.change(3, 5000);
+    REQUIRE (widths.max() == 5000);
+    widths.add(600);
+    widths.remove(5000);
+    REQUIRE (widths.max() == 600);
+    widths.change(600, 2);
+    REQUIRE (widths.max() == 2);
+    widths.remove(2);
+    REQUIRE (widths.max() == 0);
+}
+
+
+
 TEST_CASE ("Testing formulaCell")
 {
 
@@ -102,7 +269,6 @@ TEST_CASE ("Testing formulaCell")
 
         formulaCell cell("=a1+B1*100", &t);
         REQUIRE (cell.getType() == Type::FORMULA);
-        REQUIRE (cell.getDependingOn().size() == 0); //in the beginning dependingOn vector should be empty
         REQUIRE (cell.getS_Value() == "=a1+B1*100");
     }
 
@@ -116,10 +282,37 @@ TEST_CASE ("Testing formulaCell")
         REQUIRE (calc("13.5+1/2") == 14.0);
         REQUIRE (calc("3+4*2/-4^2") == 3.5);
         REQUIRE_THROWS (calc("10.5/0"));
+        REQUIRE (calc("-5+3") == -2.0);
+        REQUIRE (calc("2^3^2") == 64.0);
         #undef calc
     }
 
 
+    SECTION ("Compiling formulas")
+    {
+        std::vector<Instruction> program = formulaCell::compile("=A1*-2+B12", 1);
+        // A1 2 NEGATE * B12 +
+        REQUIRE (program.size() == 6);
+        REQUIRE (program[0].kind == Instruction::Kind::REFERENCE);
+        REQUIRE (program[0].col == 'A');
+        REQUIRE (program[0].row == 1);
+        REQUIRE (program[1].kind == Instruction::Kind::NUMBER);
+        REQUIRE (program[1].number == 2.0);
+        REQUIRE (program[2].kind == Instruction::Kind::NEGATE);
+        REQUIRE (program[3].op == '*');
+        REQUIRE (program[4].row == 12);
+        REQUIRE (program[5].op == '+');
+
+        REQUIRE_THROWS (formulaCell::compile("5+"));
+        REQUIRE_THROWS (formulaCell::compile("AB1"));
+
+        Table t;
+        formulaCell cell("=AB1+1", &t);
+        REQUIRE (cell.getProgram().empty());
+        REQUIRE_THROWS (cell.calculate());
+    }
+
+
     SECTION ("Doing undepending calculations")
     {
         Table t;
@@ -143,21 +336,35 @@ TEST_CASE ("Testing formulaCell")
         t.addRow(row2);
 
         formulaCell cell("=2^A1",&t);
-        REQUIRE (cell.getCalculationExpression() == "2^12.000000");
         REQUIRE (cell.calculate() == 4096);
         REQUIRE (cell.getNum_Value() == 4096);
 
         formulaCell cell2("=C2*B1+A1",&t);
-        REQUIRE (cell2.getCalculationExpression() == "100.000000*0.800000+12.000000");
         REQUIRE (cell2.calculate() == 92);
 
         formulaCell cell3("=A1/A2", &t);
-        REQUIRE (cell3.getCalculationExpression() == "12.000000/0.000000");
         REQUIRE_THROWS (cell3.getNum_Value());
 
         formulaCell cell4("=C2*B1+A1/A220", &t);
         REQUIRE_THROWS (cell4.getNum_Value());
     }
+
+
+    SECTION ("Calculating without losing precision")
+    {
+        std::string row1("0.1234567891, -0.0000001, \"2.5e-8\"");
+        Table t;
+        t.addRow(row1);
+
+        formulaCell cell("=A1*10", &t);
+        REQUIRE (cell.getNum_Value() == 0.1234567891 * 10);
+
+        formulaCell cell2("=A1-B1", &t);
+        REQUIRE (cell2.getNum_Value() == 0.1234567891 + 0.0000001);
+
+        formulaCell cell3("=C1*2", &t); //the string is converted to number only once
+        REQUIRE (cell3.getNum_Value() == 5e-8);
+    }
     
 
     SECTION ("Testing not that simple depending calculations")
@@ -172,8 +379,8 @@ TEST_CASE ("Testing formulaCell")
         t.addRow(row2);
 
         formulaCell cell("=A1+B2",&t);
-        cell.fill_dependingOn();
-        REQUIRE (cell.getDependingOn().size() == 2);
+        const std::vector<Instruction>& program = cell.getProgram();
+        REQUIRE (std::count_if(program.begin(), program.end(), [](const Instruction& i){ return i.kind == Instruction::Kind::REFERENCE; }) == 2);
         REQUIRE (cell.getNum_Value() == 300);
 
         formulaCell cell2("=A1*C2+B1", &t);
@@ -226,6 +433,34 @@ TEST_CASE ("Testing table")
         REQUIRE (t.whatIsThis(test) == 4);
     }
 
+    SECTION ("Converting numbers while recognizing them")
+    {
+        CellValue number;
+        REQUIRE (Table::parseValue("+42", number) == 2);
+        REQUIRE (number.type == Type::INT);
+        REQUIRE (number.integer == 42);
+
+        REQUIRE (Table::parseValue("-0.25", number) == 3);
+        REQUIRE (number.type == Type::DOUBLE);
+        REQUIRE (number.number == -0.25);
+
+        REQUIRE (Table::parseValue("\t.5", number) == 3);
+        REQUIRE (number.number == 0.5);
+
+        REQUIRE (Table::parseValue("99999999999", number) == 2);
+        REQUIRE (number.type == Type::EMPTY);
+        REQUIRE (Table::parseValue("a5", number) == 2);
+        REQUIRE (number.type == Type::EMPTY);
+
+        REQUIRE (Table::parseValue("1e5", number) == 0);
+        REQUIRE (Table::parseValue("1.", number) == 0);
+        REQUIRE (Table::parseValue("1.2.3", number) == 0);
+        REQUIRE (Table::parseValue("+-1", number) == 0);
+        REQUIRE (Table::parseValue("-.5", number) == 0);
+        REQUIRE (Table::parseValue("\"1\"", number) == 1);
+        REQUIRE (Table::parseValue("", number) == 4);
+    }
+
     SECTION ("Adding new rows")
     {
         Table t;
@@ -250,36 +485,36 @@ TEST_CASE ("Testing table")
         t.addRow(row1);
         t.addRow(row2);
 
-        Cell** cellptr = t.getCell('B', 2);
-        REQUIRE ( (*cellptr)->getType() == Type::INT );
-        REQUIRE ( (*cellptr)->getNum_Value() == 220);
-        REQUIRE ( (*cellptr)->getS_Value() == "220");
-        REQUIRE ( (*cellptr)->getSpacing() == 3);
+        Cell* cellptr = t.getCell('B', 2);
+        REQUIRE ( cellptr->getType() == Type::INT );
+        REQUIRE ( cellptr->getNum_Value() == 220);
+        REQUIRE ( cellptr->getS_Value() == "220");
+        REQUIRE ( cellptr->getSpacing() == 3);
 
         cellptr = t.getCell('A', 2);
-        REQUIRE ( (*cellptr)->getType() == Type::EMPTY );
-        REQUIRE ( (*cellptr)->getNum_Value() == 0);
-        REQUIRE ( (*cellptr)->getS_Value() == "");
-        REQUIRE ( (*cellptr)->getSpacing() == 0);
+        REQUIRE ( cellptr->getType() == Type::EMPTY );
+        REQUIRE ( cellptr->getNum_Value() == 0);
+        REQUIRE ( cellptr->getS_Value() == "");
+        REQUIRE ( cellptr->getSpacing() == 0);
 
         cellptr = t.getCell('A', 1);
-        REQUIRE ( (*cellptr)->getType() == Type::FORMULA );
-        REQUIRE ( (*cellptr)->getNum_Value() == 80);
-        REQUIRE ( (*cellptr)->getS_Value() == "=B1*C2");
-        REQUIRE ( (*cellptr)->getSpacing() == 2);
-        REQUIRE_NOTHROW ( (*cellptr)->print() );
+        REQUIRE ( cellptr->getType() == Type::FORMULA );
+        REQUIRE ( cellptr->getNum_Value() == 80);
+        REQUIRE ( cellptr->getS_Value() == "=B1*C2");
+        REQUIRE ( cellptr->getSpacing() == 2);
+        REQUIRE_NOTHROW ( cellptr->print() );
 
         cellptr = t.getCell('C', 2);
-        REQUIRE ( (*cellptr)->getType() == Type::STRING );
-        REQUIRE ( (*cellptr)->getNum_Value() == 100);
-        REQUIRE ( (*cellptr)->getS_Value() == "\"100\"");
-        REQUIRE ( (*cellptr)->getSpacing() == 3);
+        REQUIRE ( cellptr->getType() == Type::STRING );
+        REQUIRE ( cellptr->getNum_Value() == 100);
+        REQUIRE ( cellptr->getS_Value() == "\"100\"");
+        REQUIRE ( cellptr->getSpacing() == 3);
 
         cellptr = t.getCell('C', 1);
-        REQUIRE ( (*cellptr)->getType() == Type::STRING );
-        REQUIRE ( (*cellptr)->getNum_Value() == 0);
-        REQUIRE ( (*cellptr)->getS_Value() == "\"Hey\"");
-        REQUIRE ( (*cellptr)->getSpacing() == 3);
+        REQUIRE ( cellptr->getType() == Type::STRING );
+        REQUIRE ( cellptr->getNum_Value() == 0);
+        REQUIRE ( cellptr->getS_Value() == "\"Hey\"");
+        REQUIRE ( cellptr->getSpacing() == 3);
 
         cellptr = t.getCell('C', 60);
         REQUIRE (cellptr == nullptr);
@@ -303,23 +538,162 @@ TEST_CASE ("Testing table")
 
         REQUIRE_NOTHROW (t.print());
 
-        Cell** cellptr = t.getCell('A', 1);
-        REQUIRE ( (*cellptr)->getType() == Type::INT );
-        REQUIRE ( (*cellptr)->getNum_Value() == 20);
-        REQUIRE ( (*cellptr)->getS_Value() == "20");
-        REQUIRE ( (*cellptr)->getSpacing() == 2);
+        Cell* cellptr = t.getCell('A', 1);
+        REQUIRE ( cellptr->getType() == Type::INT );
+        REQUIRE ( cellptr->getNum_Value() == 20);
+        REQUIRE ( cellptr->getS_Value() == "20");
+        REQUIRE ( cellptr->getSpacing() == 2);
 
         cellptr = t.getCell('A', 2);
-        REQUIRE ( (*cellptr)->getType() == Type::EMPTY );
-        REQUIRE ( (*cellptr)->getNum_Value() == 0);
-        REQUIRE ( (*cellptr)->getS_Value() == "");
-        REQUIRE ( (*cellptr)->getSpacing() == 0);
+        REQUIRE ( cellptr->getType() == Type::EMPTY );
+        REQUIRE ( cellptr->getNum_Value() == 0);
+        REQUIRE ( cellptr->getS_Value() == "");
+        REQUIRE ( cellptr->getSpacing() == 0);
 
         cellptr = t.getCell('C', 1);
         REQUIRE (cellptr == nullptr);
     }
 
 
+    SECTION ("Mapped file constructor")
+    {
+        std::ofstream write("test.csv", std::ios::trunc);
+        if (!write.is_open()){
+            throw std::runtime_error("Error loading file");
+        }
+        write << "20,\"Y\\\"es\", +7\n";
+        write << ", 42, =a1 + c1 ,\n";
+        write << " -1.50 ";
+        write.close();
+
+        MappedFile file("test.csv");
+        Table t(file.getData());
+        // 20   | Y"es |  7
+        //      |   42 | 27
+        // -1.5 |      |
+
+        REQUIRE (t.getCell('B', 1)->getS_Value() == "\"Y\\\"es\"");
+        REQUIRE (t.getCell('C', 1)->getNum_Value() == 7);
+        REQUIRE (t.getCell('C', 2)->getS_Value() == "=A1+C1");
+        REQUIRE (t.getCell('C', 2)->getNum_Value() == 27);
+        REQUIRE (t.getCell('A', 3)->getNum_Value() == -1.5);
+        REQUIRE (t.getCell('A', 4) == nullptr);
+
+        REQUIRE_THROWS_WITH (Table(std::string_view("1,2\n3,x")), "Error: row 2, col 2, x is unknown data type");
+        REQUIRE_THROWS_WITH (Table(std::string_view("99999999999")), "Number too Big!");
+        REQUIRE_THROWS (MappedFile("no such file.csv"));
+    }
+
+
+    SECTION ("Reading the rows when they are used")
+    {
+        std::ofstream write("lazy.csv", std::ios::trunc);
+        write << "=A600+1, \"x\"";
+        for (size_t i=2; i<=600; ++i){
+            write << "\n" << i << ", =A" << i << "*2";
+        }
+        write.close();
+
+        Table t(std::unique_ptr<MappedFile>(new MappedFile("lazy.csv")));
+        REQUIRE (t.getCell('A', 601) == nullptr);
+        REQUIRE (t.getCell('C', 1) == nullptr);
+        REQUIRE (t.getCell('B', 300)->getNum_Value() == 600);
+        REQUIRE (t.getCell('A', 1)->getNum_Value() == 601); //reads the last block too
+
+        std::string newValue("1");
+        t.setValue('A', 600, newValue);
+        REQUIRE (t.getCell('A', 1)->getNum_Value() == 2);
+
+        //the same as reading everything at once
+        t.readRows();
+        MappedFile file("lazy.csv");
+        Table eager(file.getData());
+        eager.setValue('A', 600, newValue);
+        bool same = true;
+        for (size_t i=1; i<=600; ++i){
+            same = same && t.getCell('B', i)->getNum_Value() == eager.getCell('B', i)->getNum_Value();
+        }
+        REQUIRE (same);
+
+        //the unknown data type is found when its row is read
+        write.open("lazy.csv", std::ios::trunc);
+        for (size_t i=1; i<=300; ++i){
+            write << (i == 280 ? "abc" : "1") << "\n";
+        }
+        write.close();
+
+        Table damaged(std::unique_ptr<MappedFile>(new MappedFile("lazy.csv")));
+        REQUIRE (damaged.getCell('A', 2)->getNum_Value() == 1);
+        REQUIRE_THROWS_WITH (damaged.getCell('A', 259), "Error: row 280, col 1, abc is unknown data type");
+        REQUIRE_THROWS_WITH (damaged.readRows(), "Error: row 280, col 1, abc is unknown data type");
+
+        //the recalculation stopped by the damaged row can be started again
+        std::string formula("=A280");
+        REQUIRE_THROWS (damaged.setValue('B', 1, formula));
+        formula = "=2*3";
+        damaged.setValue('B', 2, formula);
+        REQUIRE (!static_cast<formulaCell*>(damaged.getCell('B', 2))->isDirty());
+        REQUIRE (damaged.getCell('B', 2)->getNum_Value() == 6);
+
+        //a block read after the next one still ends before the next one
+        write.open("lazy.csv", std::ios::trunc);
+        write << "123456789";
+        for (size_t i=2; i<=600; ++i){
+            write << "\n" << (i == 550 ? "abc" : std::to_string(i % 10));
+        }
+        write.close();
+
+        Table unordered(std::unique_ptr<MappedFile>(new MappedFile("lazy.csv")));
+        REQUIRE (unordered.getCell('A', 300)->getNum_Value() == 0);
+        REQUIRE (unordered.getCell('A', 1)->getNum_Value() == 123456789);
+        REQUIRE_THROWS_WITH (unordered.getCell('A', 550), "Error: row 550, col 1, abc is unknown data type");
+
+        //and its rows are counted once
+        write.open("lazy.csv", std::ios::trunc);
+        write << "123456789";
+        for (size_t i=2; i<=600; ++i){
+            write << "\n" << i % 10;
+        }
+        write.close();
+
+        Table counted(std::unique_ptr<MappedFile>(new MappedFile("lazy.csv")));
+        REQUIRE (counted.getCell('A', 300)->getNum_Value() == 0);
+        newValue = "1";
+        counted.setValue('A', 1, newValue);
+        std::ostringstream printed;
+        std::streambuf* console = std::cout.rdbuf(printed.rdbuf());
+        counted.print();
+        std::cout.rdbuf(console);
+        REQUIRE (printed.str().substr(0, 12) == "     | A | \n");
+    }
+
+
+    SECTION ("Parsing with several threads")
+    {
+        std::string data;
+        for (size_t i=1; i<=1000; ++i){
+            data += std::to_string(i) + ", \"row " + std::to_string(i % 7) + "\", =A" + std::to_string(i) + "*2\n";
+        }
+
+        Table t;
+        t.readFromBuffer(data, 4);
+        // the new line at the end means an empty last row
+        REQUIRE (t.getCell('A', 1001)->getType() == Type::EMPTY);
+        REQUIRE (t.getCell('A', 1002) == nullptr);
+        REQUIRE (t.getCell('A', 500)->getNum_Value() == 500);
+        REQUIRE (t.getCell('B', 999)->getS_Value() == "\"row 5\"");
+        REQUIRE (t.getCell('C', 1000)->getNum_Value() == 2000);
+
+        std::string invalid = data;
+        invalid.replace(invalid.find("\"row 3\"", invalid.size() / 2), 7, "row 3");
+        invalid.replace(invalid.rfind("\"row 1\""), 7, "12345678901");
+        Table t2;
+        REQUIRE_THROWS_WITH (t2.readFromBuffer(invalid, 4), "Error: row 507, col 2, row 3 is unknown data type");
+        Table t3;
+        REQUIRE_THROWS_WITH (t3.readFromBuffer(invalid, 1), "Error: row 507, col 2, row 3 is unknown data type");
+    }
+
+
     SECTION ("Setting new values")
     {
         std::string row1("=B1*C2, 0.8, 123");
@@ -339,11 +713,11 @@ TEST_CASE ("Testing table")
         newValue = "\"Hello\"";
         REQUIRE_NOTHROW (t.setValue('A',1,newValue));
         
-        Cell** cellptr = t.getCell('A', 1);
-        REQUIRE ( (*cellptr)->getType() == Type::STRING );
-        REQUIRE ( (*cellptr)->getNum_Value() == 0);
-        REQUIRE ( (*cellptr)->getS_Value() == "\"Hello\"");
-        REQUIRE ( (*cellptr)->getSpacing() == 5);
+        Cell* cellptr = t.getCell('A', 1);
+        REQUIRE ( cellptr->getType() == Type::STRING );
+        REQUIRE ( cellptr->getNum_Value() == 0);
+        REQUIRE ( cellptr->getS_Value() == "\"Hello\"");
+        REQUIRE ( cellptr->getSpacing() == 5);
 
         newValue = "=B2+C2";
         REQUIRE_NOTHROW (t.setValue('D',5,newValue));
@@ -354,17 +728,220 @@ TEST_CASE ("Testing table")
         //    |     |     | 320 |
 
         cellptr = t.getCell('D', 5); 
-        REQUIRE ( (*cellptr)->getType() == Type::FORMULA );
-        REQUIRE ( (*cellptr)->getNum_Value() == 320);
-        REQUIRE ( (*cellptr)->getS_Value() == "=B2+C2");
-        REQUIRE ( (*cellptr)->getSpacing() == 3);
+        REQUIRE ( cellptr->getType() == Type::FORMULA );
+        REQUIRE ( cellptr->getNum_Value() == 320);
+        REQUIRE ( cellptr->getS_Value() == "=B2+C2");
+        REQUIRE ( cellptr->getSpacing() == 3);
 
         t.align(); //we have to align otherwise, D3 wont exist
         cellptr = t.getCell('D', 3); 
-        REQUIRE ( (*cellptr)->getType() == Type::EMPTY );
-        REQUIRE ( (*cellptr)->getNum_Value() == 0);
-        REQUIRE ( (*cellptr)->getS_Value() == "");
-        REQUIRE ( (*cellptr)->getSpacing() == 0); 
+        REQUIRE ( cellptr->getType() == Type::EMPTY );
+        REQUIRE ( cellptr->getNum_Value() == 0);
+        REQUIRE ( cellptr->getS_Value() == "");
+        REQUIRE ( cellptr->getSpacing() == 0); 
+    }
+
+
+    SECTION ("Sharing equal strings")
+    {
+        Table t;
+        std::string row("\"a\\\\b\", \"42\", \"a\\\\b\"");
+        t.addRow(row);
+        t.addRow(row);
+        std::string newValue("\"42\"");
+        t.setValue('A', 2, newValue);
+
+        REQUIRE (t.getCell('A', 1)->getS_Value() == "\"a\\\\b\"");
+        REQUIRE (t.getCell('C', 2)->getS_Value() == "\"a\\\\b\"");
+        REQUIRE (t.getCell('A', 2)->getS_Value() == "\"42\"");
+        REQUIRE (t.getCell('A', 2)->getNum_Value() == 42);
+        REQUIRE (t.getCell('B', 1)->getSpacing() == 2);
+        REQUIRE (stringCell::escape("\"\\", 2) == "\"\\\"\\\\\"");
+
+        //a string no cell has anymore is released and its entry is taken by the next new string
+        newValue = "\"first\"";
+        t.setValue('D', 1, newValue);
+        newValue = "\"1st\"";
+        t.setValue('D', 1, newValue);
+        newValue = "\"first\"";
+        t.setValue('D', 2, newValue);
+        t.setValue('B', 1, newValue);
+        REQUIRE (t.getCell('D', 1)->getS_Value() == "\"1st\"");
+        REQUIRE (t.getCell('D', 2)->getS_Value() == "\"first\"");
+        REQUIRE (t.getCell('B', 1)->getS_Value() == "\"first\"");
+        REQUIRE (t.getCell('B', 2)->getS_Value() == "\"42\"");
+        REQUIRE (t.getCell('A', 2)->getNum_Value() == 42);
+    }
+
+
+    SECTION ("Editing far away cells")
+    {
+        Table t;
+        std::string newValue("1");
+        t.setValue('Z', 500000, newValue);
+        newValue = "=Z500000+A499999";
+        t.setValue('B', 3, newValue);
+
+        Cell* cellptr = t.getCell('Z', 500000);
+        REQUIRE (cellptr->getType() == Type::INT);
+        REQUIRE (cellptr->getNum_Value() == 1);
+
+        cellptr = t.getCell('A', 250000);
+        REQUIRE (cellptr->getType() == Type::EMPTY);
+        REQUIRE (cellptr->getSpacing() == 0);
+
+        REQUIRE (t.getCell('A', 500001) == nullptr);
+        REQUIRE (t.getCell('B', 3)->getNum_Value() == 1);
+
+        newValue = "\"x\"";
+        t.setValue('A', 499999, newValue);
+        newValue = "2";
+        t.setValue('Z', 500000, newValue);
+        REQUIRE (t.getCell('B', 3)->getNum_Value() == 2);
+        REQUIRE (t.getCell('A', 499999)->getS_Value() == "\"x\"");
+    }
+
+
+    SECTION ("Opening a wide file")
+    {
+        //rows with more than 64 columns
+        std::string contents;
+        for (size_t i=1; i<=70; ++i){
+            contents += std::to_string(i) + (i < 70 ? "," : "\n");
+        }
+        contents += std::string(69, ',') + "\"end\"\n";
+        contents += "=A1+1" + std::string(69, ',');
+
+        std::ofstream write("wide.csv", std::ios::trunc);
+        write << contents;
+        write.close();
+
+        std::ifstream file("wide.csv");
+        Table t(file);
+        REQUIRE (t.getCell('A', 3)->getNum_Value() == 2);
+        REQUIRE_NOTHROW (t.print());
+
+        //the values after the 64th column are moved when a cell is added before them
+        std::string newValue("5");
+        t.setValue('B', 2, newValue);
+        newValue = ",";
+        contents.replace(contents.find(newValue, contents.find('\n')), 1, ",5,");
+        contents.erase(contents.find(",\"end"), 1);
+
+        std::ofstream saved("saved.csv", std::ios::trunc);
+        t.saveInFile(saved);
+        saved.close();
+        std::ifstream read("saved.csv");
+        std::string savedContents((std::istreambuf_iterator<char>(read)), std::istreambuf_iterator<char>());
+        REQUIRE (savedContents == contents);
+
+        //the same in the binary format, in a snapshot and in a lazily opened file
+        saved.open("saved.sheet", std::ios::trunc | std::ios::binary);
+        t.saveBinary(saved);
+        saved.close();
+        Table binary(MappedFile("saved.sheet").getData());
+        std::unique_ptr<Table> copy = t.snapshot();
+        Table lazy(std::unique_ptr<MappedFile>(new MappedFile("saved.csv")));
+        for (Table* other : {&binary, copy.get(), &lazy}){
+            saved.open("resaved.csv", std::ios::trunc);
+            other->saveInFile(saved);
+            saved.close();
+            REQUIRE (MappedFile("resaved.csv").getData() == contents);
+        }
+    }
+
+
+    SECTION ("Recalculating dependent formulas")
+    {
+        std::string row1("1, =A1*2, =B1+1, =5+5");
+        // 1 | 2 | 3 | 10
+        Table t;
+        t.addRow(row1);
+        t.align();
+
+        formulaCell* b1 = static_cast<formulaCell*>(t.getCell('B', 1));
+        formulaCell* c1 = static_cast<formulaCell*>(t.getCell('C', 1));
+        formulaCell* d1 = static_cast<formulaCell*>(t.getCell('D', 1));
+        REQUIRE (c1->getSpacing() == 1);
+        REQUIRE (!b1->isDirty());
+
+        std::string newValue("50");
+        t.setValue('A', 1, newValue);
+        // 50 | 100 | 101 | 10
+        REQUIRE (!b1->isDirty());
+        REQUIRE (!c1->isDirty());
+        REQUIRE (b1->getSpacing() == 3);
+        REQUIRE (c1->getSpacing() == 3);
+        REQUIRE (c1->getNum_Value() == 101);
+        REQUIRE (d1->getSpacing() == 2);
+
+        newValue = "=D1*3";
+        t.setValue('B', 1, newValue);
+        // 50 | 30 | 31 | 10
+        b1 = static_cast<formulaCell*>(t.getCell('B', 1));
+        REQUIRE (b1->getSpacing() == 2);
+        REQUIRE (c1->getNum_Value() == 31);
+
+        newValue = "0";
+        t.setValue('D', 1, newValue);
+        newValue = "7";
+        t.setValue('A', 1, newValue); //B1 no longer depends on A1
+        REQUIRE (c1->getNum_Value() == 1);
+    }
+
+
+    SECTION ("Calculating shared sub-chains only once")
+    {
+        // A1 = 1, A2 = A1+A1, A3 = A2+A2, ... A40 = A39+A39
+        Table t;
+        t.addRow("1");
+        for (size_t i=2; i<=40; ++i){
+            t.addRow("=A" + std::to_string(i-1) + "+A" + std::to_string(i-1));
+        }
+
+        REQUIRE ( t.getCell('A', 40)->getNum_Value() == 549755813888.0); // 2^39
+
+        std::string newValue("2");
+        t.setValue('A', 1, newValue);
+        REQUIRE ( t.getCell('A', 40)->getNum_Value() == 1099511627776.0); // 2^40
+    }
+
+
+    SECTION ("Calculating in one phase before printing")
+    {
+        Table t;
+        t.addRow("1, =A1+1, =A1*30");
+        formulaCell* b1 = static_cast<formulaCell*>(t.getCell('B', 1));
+        formulaCell* c1 = static_cast<formulaCell*>(t.getCell('C', 1));
+
+        //asking for a width calculates all dirty formulas together, printing only reads them
+        REQUIRE (b1->getSpacing() == 1);
+        REQUIRE (!c1->isDirty());
+        REQUIRE (c1->getResult_String() == "30");
+    }
+
+
+    SECTION ("Finding infinite cell referencing")
+    {
+        std::string row1("=B1, =A1, =A1+1, 5, =E1");
+        // #ERROR | #ERROR | #ERROR | 5 | #ERROR
+        Table t;
+        t.addRow(row1);
+        t.align();
+
+        REQUIRE ( t.getCell('A', 1)->getSpacing() == 6);
+        REQUIRE ( t.getCell('B', 1)->getSpacing() == 6);
+        REQUIRE ( t.getCell('C', 1)->getSpacing() == 6);
+        REQUIRE ( t.getCell('D', 1)->getSpacing() == 1);
+        REQUIRE ( t.getCell('E', 1)->getSpacing() == 6);
+        REQUIRE_THROWS ( t.getCell('C', 1)->getNum_Value());
+
+        std::string newValue("=D1");
+        t.setValue('B', 1, newValue);
+        // 5 | 5 | 6 | 5 | #ERROR
+        REQUIRE ( t.getCell('A', 1)->getNum_Value() == 5);
+        REQUIRE ( t.getCell('C', 1)->getNum_Value() == 6);
+        REQUIRE ( t.getCell('E', 1)->getSpacing() == 6);
     }
 
 
@@ -388,6 +965,42 @@ TEST_CASE ("Testing table")
     }
 
 
+    SECTION ("Printing a range")
+    {
+        Table t;
+        t.addRow("=B1*2, 1, \"long text here\"");
+        t.addRow("=A1+1, 22");
+        t.addRow("=1/0");
+
+        std::ostringstream printed;
+        std::streambuf* console = std::cout.rdbuf(printed.rdbuf());
+        t.print(0, 1, 1, 2);
+        std::cout.rdbuf(console);
+
+        //only the range is calculated and measured
+        REQUIRE (printed.str() == "   | A | B  | \n 1 | 2 |  1 | \n 2 | 3 | 22 | \n");
+        REQUIRE (static_cast<formulaCell*>(t.getCell('A', 3))->isDirty());
+
+        REQUIRE_THROWS (t.print(3, 1, 4, 2));
+        REQUIRE_THROWS (t.print(0, 4, 2, 9));
+        REQUIRE_THROWS (t.printPage(2));
+        std::ostringstream page;
+        console = std::cout.rdbuf(page.rdbuf());
+        t.printPage(1);
+        std::cout.rdbuf(console);
+        REQUIRE (page.str().find("| C              |") != std::string::npos); //the page has all the columns
+        REQUIRE (!static_cast<formulaCell*>(t.getCell('A', 3))->isDirty());
+
+        //the same rows can be written straight to a file
+        std::FILE* file = std::fopen("printed.txt", "wb");
+        t.print(0, 1, 1, 2, fileno(file));
+        std::fclose(file);
+        std::ifstream read("printed.txt");
+        std::string contents((std::istreambuf_iterator<char>(read)), std::istreambuf_iterator<char>());
+        REQUIRE (contents == printed.str());
+    }
+
+
     SECTION ("Saving in file")
     {
         std::string row1("=B1*C2, 0.8, 123");
@@ -422,6 +1035,154 @@ TEST_CASE ("Testing table")
         
         read.close();
     }
+
+
+    SECTION ("Saving without calculating")
+    {
+        Table t;
+        std::string row1("=A2+1, 1234567.125, \"say \\\"hi\\\"\"");
+        std::string row2("=A1+1");
+        t.addRow(row1);
+        t.addRow(row2);
+        t.addRow("");
+        t.addRow(", -3");
+
+        std::ofstream write("saved.csv", std::ios::trunc);
+        t.saveInFile(write);
+        write.close();
+
+        //A1 and A2 refer each other, but nothing is calculated
+        formulaCell* formula = static_cast<formulaCell*>(t.getCell('A', 1));
+        REQUIRE (formula->isDirty());
+
+        std::ifstream read("saved.csv");
+        std::string contents((std::istreambuf_iterator<char>(read)), std::istreambuf_iterator<char>());
+        REQUIRE (contents == "=A2+1,1234567.125,\"say \\\"hi\\\"\"\n=A1+1,,\n,,\n,-3,");
+    }
+
+
+    SECTION ("Saving in binary file")
+    {
+        std::string row1("=B1*C2, 0.8, \"a\\\"b\", =A3");
+        std::string row2(",220,\"100\",=1/0");
+        std::string row3("=D1+1");
+        // 80 | 0.8 | a"b    | #ERROR
+        //    | 220 | 100    | #ERROR
+        // #ERROR (A3 and D1 refer each other)
+        Table t;
+        t.addRow(row1);
+        t.addRow(row2);
+        t.addRow(row3);
+        std::string newValue("-7");
+        t.setValue('C', 5, newValue);
+        newValue = "\"unused\"";
+        t.setValue('E', 1, newValue);
+        newValue = "7";
+        t.setValue('E', 1, newValue);
+
+        std::ofstream write("saved.sheet", std::ios::trunc | std::ios::binary);
+        if (!write.is_open()){
+            throw std::runtime_error("Error loading file");
+        }
+        t.saveBinary(write);
+        write.close();
+
+        MappedFile file("saved.sheet");
+        REQUIRE (Table::isBinary(file.getData()));
+        REQUIRE (file.getData().find("unused") == std::string_view::npos); //no cell has the string anymore
+        Table read(file.getData());
+
+        Cell* cellptr = read.getCell('A', 1);
+        REQUIRE (cellptr->getType() == Type::FORMULA);
+        REQUIRE (cellptr->getS_Value() == "=B1*C2");
+        REQUIRE (cellptr->getNum_Value() == 80);
+        REQUIRE (read.getCell('C', 1)->getS_Value() == "\"a\\\"b\"");
+        REQUIRE (read.getCell('C', 2)->getNum_Value() == 100);
+        REQUIRE (read.getCell('C', 5)->getNum_Value() == -7);
+        REQUIRE (read.getCell('D', 2)->getSpacing() == 6);
+        REQUIRE (read.getCell('D', 1)->getSpacing() == 6);
+        REQUIRE (read.getCell('A', 4)->getType() == Type::EMPTY);
+        REQUIRE (read.getCell('A', 6) == nullptr);
+
+        //the dependencies are restored
+        newValue = "1";
+        read.setValue('C', 2, newValue);
+        REQUIRE (read.getCell('A', 1)->getNum_Value() == 0.8);
+
+        std::string data(file.getData());
+        data.resize(data.size() - 10);
+        REQUIRE_THROWS_WITH (Table(std::string_view(data)), "Error: the file is damaged");
+
+        //the stored program of =1/0 is checked before it can be executed
+        data = file.getData();
+        size_t program = data.find("=1/0") + 4 + 1 + sizeof(double) + 4; //after the text, flags, result and size
+        data[program] = char(Instruction::Kind::OPERATOR);                  //nothing to pop yet
+        REQUIRE_THROWS_WITH (Table(std::string_view(data)), "Error: the file is damaged");
+        data = file.getData();
+        data[program + 2 * 19 + 1] = '%';                                   //the operator of the third instruction
+        REQUIRE_THROWS_WITH (Table(std::string_view(data)), "Error: the file is damaged");
+    }
+
+
+    SECTION ("Saving in compressed file")
+    {
+        Table t;
+        for (size_t i=0; i<300; ++i){
+            t.addRow(std::to_string(i) + ", \"repeated\", =A" + std::to_string(i + 1) + "*2");
+        }
+
+        std::ofstream write("saved.csvz", std::ios::trunc | std::ios::binary);
+        t.saveInFile(write, true);
+        write.close();
+        write.open("saved.sheetz", std::ios::trunc | std::ios::binary);
+        t.saveBinary(write, true);
+        write.close();
+
+        MappedFile text("saved.csvz");
+        MappedFile binary("saved.sheetz");
+        REQUIRE (BlockCodec::isCompressed(text.getData()));
+        REQUIRE (BlockCodec::isCompressed(binary.getData()));
+
+        Table fromText(text.getData());
+        Table fromBinary(std::unique_ptr<MappedFile>(new MappedFile("saved.sheetz")));
+        REQUIRE (fromText.getCell('C', 300)->getS_Value() == "=A300*2");
+        REQUIRE (fromText.getCell('C', 300)->getNum_Value() == 598);
+        REQUIRE (fromBinary.getCell('C', 300)->getNum_Value() == 598);
+        REQUIRE (fromBinary.getCell('B', 7)->getS_Value() == "\"repeated\"");
+
+        //a string longer than the biggest block is split into several blocks
+        std::string longText = "\"" + std::string(BlockCodec::MAX_BLOCK + 100, 'x') + "\"";
+        t.setValue('D', 1, longText);
+        write.open("saved.sheetz", std::ios::trunc | std::ios::binary);
+        t.saveBinary(write, true);
+        write.close();
+        Table longBinary(std::unique_ptr<MappedFile>(new MappedFile("saved.sheetz")));
+        REQUIRE (longBinary.getCell('D', 1)->getS_Value() == longText);
+    }
+
+
+    SECTION ("Copying the table")
+    {
+        std::string row1("=B1+1, 2, \"two\"");
+        Table t;
+        t.addRow(row1);
+        t.addRow(",,\"two\"");
+        std::unique_ptr<Table> copy = t.snapshot();
+
+        //the copy is not changed by the edits of the table and the other way round
+        std::string newValue("10");
+        t.setValue('B', 1, newValue);
+        newValue = "\"three\"";
+        t.setValue('C', 2, newValue);
+        REQUIRE (t.getCell('A', 1)->getNum_Value() == 11);
+        REQUIRE (copy->getCell('A', 1)->getNum_Value() == 3);
+        REQUIRE (copy->getCell('C', 2)->getS_Value() == "\"two\"");
+
+        newValue = "=B1*2";
+        copy->setValue('A', 2, newValue);
+        REQUIRE (copy->getCell('A', 2)->getNum_Value() == 4);
+        REQUIRE (t.getCell('A', 2)->getType() == Type::EMPTY);
+    }
 }
 
 
@@ -519,6 +1280,87 @@ TEST_CASE ("Testing commands")
         REQUIRE (!cmds.isThereTable());
         REQUIRE (cmds.getPath().size() == 0);
     }
+
+    SECTION ("Saving in the background")
+    {
+        std::ofstream write("background.csv", std::ios::trunc);
+        write << "1,2";
+        write.close();
+
+        Commands cmds;
+        cmds.OPEN("background.csv");
+        std::string newValue("=A1+B1");
+        cmds.EDIT("C1", newValue);
+        cmds.SAVE();
+
+        //the save writes the table as it was when SAVE was called
+        newValue = "5";
+        cmds.EDIT("A1", newValue);
+        cmds.waitForSave();
+
+        std::ifstream read("background.csv");
+        std::string contents((std::istreambuf_iterator<char>(read)), std::istreambuf_iterator<char>());
+        read.close();
+        REQUIRE (contents == "1,2,=A1+B1");
+
+        std::remove("background2.csv"); //else SAVEAS asks if the file is overwritten
+        cmds.SAVEAS("background2.csv");
+        REQUIRE (cmds.getPath() == "background2.csv");
+        cmds.CLOSE(); //the edit is saved, so nothing is asked
+
+        read.open("background2.csv");
+        contents.assign((std::istreambuf_iterator<char>(read)), std::istreambuf_iterator<char>());
+        REQUIRE (contents == "5,2,=A1+B1");
+    }
+
+
+    SECTION ("Working in journal mode")
+    {
+        std::ofstream write("journaled.csv", std::ios::trunc);
+        write << "20,\"Yes\"";
+        write.close();
+
+        Commands cmds;
+        REQUIRE_THROWS (cmds.JOURNAL(true));
+        cmds.OPEN("journaled.csv");
+        cmds.JOURNAL(true);
+
+        std::string newValue("=A1*2");
+        cmds.EDIT("C1", newValue);
+        newValue = "\"a,b\"";
+        cmds.EDIT("B2", newValue);
+        REQUIRE_NOTHROW (cmds.SAVE());
+        newValue = "1";
+        cmds.EDIT("A1", newValue);
+        cmds.SAVE();
+        cmds.CLOSE();
+
+        //the document itself is not changed
+        std::ifstream read("journaled.csv");
+        std::string contents((std::istreambuf_iterator<char>(read)), std::istreambuf_iterator<char>());
+        read.close();
+        REQUIRE (contents == "20,\"Yes\"");
+
+        //the unfinished record at the end is ignored
+        std::ofstream append(Journal::pathOf("journaled.csv"), std::ios::app | std::ios::binary);
+        append << "D";
+        append.close();
+
+        Table t{std::string_view(contents)};
+        REQUIRE (Journal::replay("journaled.csv", t) == 3);
+        REQUIRE (t.getCell('C', 1)->getNum_Value() == 2);
+        REQUIRE (t.getCell('B', 2)->getS_Value() == "\"a,b\"");
+
+        cmds.OPEN("journaled.csv");
+        REQUIRE_NOTHROW (cmds.COMPACT());
+        cmds.CLOSE();
+
+        std::ifstream check(Journal::pathOf("journaled.csv"));
+        REQUIRE (!check.is_open());
+        read.open("journaled.csv");
+        contents.assign((std::istreambuf_iterator<char>(read)), std::istreambuf_iterator<char>());
+        REQUIRE (contents == "1,\"Yes\",=A1*2\n,\"a,b\",");
+    }
 }
 
 
@@ -540,6 +1382,7 @@ TEST_CASE ("Testing Program")
         Program p;
 
         p.executeCommand("open test.csv");
+        REQUIRE_THROWS (p.executeCommand("open test.csv eager"));
         REQUIRE_THROWS (p.executeCommand("save arg"));
         REQUIRE_THROWS (p.executeCommand("+-alsjnd"));
         REQUIRE_THROWS (p.executeCommand("yes.csv saveas"));
@@ -550,6 +1393,11 @@ TEST_CASE ("Testing Program")
         REQUIRE_THROWS (p.executeCommand("edit A0 123"));
         REQUIRE_THROWS (p.executeCommand("edit a-1 123"));
         REQUIRE_THROWS (p.executeCommand("exit x"));
+        REQUIRE_THROWS (p.executeCommand("print A1"));
+        REQUIRE_THROWS (p.executeCommand("print B2:A1"));
+        REQUIRE_THROWS (p.executeCommand("print page"));
+        REQUIRE_THROWS (p.executeCommand("print page -1"));
+        REQUIRE_THROWS (p.executeCommand("print page 2"));
     }
 
 
@@ -567,6 +1415,10 @@ TEST_CASE ("Testing Program")
 
         Program p;
 
+        REQUIRE_NOTHROW (p.executeCommand("open test.csv LAZY"));
+        REQUIRE_NOTHROW (p.executeCommand("get B2"));
+        REQUIRE_NOTHROW (p.executeCommand("print b2:c9"));
+        REQUIRE_NOTHROW (p.executeCommand("PRINT PAGE 1"));
         p.executeCommand("open test.csv");
         REQUIRE_NOTHROW (p.executeCommand("get A1"));
         REQUIRE_NOTHROW (p.executeCommand("GET A1"));
@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+
+//////////////////////////////////////////////////////
+///@brief Allocates memory for a table by moving a pointer forward in big chunks.
+///       Nothing is freed separately, all chunks are freed together when the arena is destroyed.
+///
+//////////////////////////////////////////////////////
+class Arena {
+
+private:
+
+    //////////////////////////////////////////////////////
+    ///@brief All chunks allocated so far.
+    ///
+    //////////////////////////////////////////////////////
+    std::vector <char*> chunks;
+
+    //////////////////////////////////////////////////////
+    ///@brief The sizes of the chunks, in the order of chunks.
+    ///
+    //////////////////////////////////////////////////////
+    std::vector <size_t> sizes;
+
+    //////////////////////////////////////////////////////
+    ///@brief The free part of the last chunk is [current, end).
+    ///
+    //////////////////////////////////////////////////////
+    char* current;
+    char* end;
+
+    //////////////////////////////////////////////////////
+    ///@brief The size of a regular chunk.
+    ///
+    //////////////////////////////////////////////////////
+    size_t chunkSize;
+
+public:
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a new Arena object. No memory is allocated yet.
+    ///
+    ///@param chunkSize The size of a regular chunk. Bigger allocations get a chunk of their own.
+    //////////////////////////////////////////////////////
+    Arena(size_t chunkSize = 1 << 20);
+
+    Arena (const Arena&) = delete;
+
+    Arena& operator= (const Arena&) = delete;
+
+    //////////////////////////////////////////////////////
+    ///@brief Free all chunks at once.
+    ///
+    //////////////////////////////////////////////////////
+    ~Arena();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Allocate memory. It stays valid until the arena is destroyed.
+    ///
+    ///@param size Number of bytes.
+    ///@param alignment Alignment of the memory. Must be a power of 2.
+    ///@return Pointer to the allocated memory.
+    //////////////////////////////////////////////////////
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Allocate memory for an array.
+    ///
+    ///@param count Number of elements. T must be trivially destructible.
+    ///@return Pointer to the first (uninitialized) element.
+    //////////////////////////////////////////////////////
+    template <typename T>
+    T* allocateArray(size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the number of bytes taken from the system.
+    ///
+    ///@return The total size of all chunks.
+    //////////////////////////////////////////////////////
+    size_t getReserved() const;
+};
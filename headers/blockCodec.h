@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+
+//////////////////////////////////////////////////////
+///@brief A fast LZ-class compressor in the LZ4 block format, and the compressed
+///       file format built on it: a header, then blocks which are compressed
+///       independently, so they are decompressed on several threads.
+///       Every block is preceded by its size before and after the compression.
+///       A block with size 0 ends the file.
+//////////////////////////////////////////////////////
+class BlockCodec {
+
+public:
+
+    //////////////////////////////////////////////////////
+    ///@brief The biggest block decompressFile() accepts, to reject damaged sizes.
+    ///
+    //////////////////////////////////////////////////////
+    static const size_t MAX_BLOCK = 1 << 24;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the biggest possible compressed size.
+    ///
+    ///@param size Size of the data.
+    ///@return The size the buffer for compress() needs.
+    //////////////////////////////////////////////////////
+    static size_t bound(size_t size);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Compress data in the LZ4 block format.
+    ///
+    ///@param data The data.
+    ///@param size Size of the data.
+    ///@param compressed Buffer of at least bound(size) bytes.
+    ///@return The compressed size.
+    //////////////////////////////////////////////////////
+    static size_t compress(const char* data, size_t size, char* compressed);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Decompress data compressed by compress(). If the data is damaged, throw an exception.
+    ///
+    ///@param compressed The compressed data.
+    ///@param size Size of the compressed data.
+    ///@param data Buffer for the decompressed data.
+    ///@param dataSize The decompressed size, the data must fill it exactly.
+    //////////////////////////////////////////////////////
+    static void decompress(const char* compressed, size_t size, char* data, size_t dataSize);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Append the header of a compressed file.
+    ///
+    ///@param out Where the header is appended.
+    //////////////////////////////////////////////////////
+    static void writeHeader(std::string& out);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Compress a block and append it to a compressed file. Blocks which do not get smaller are stored as they are.
+    ///
+    ///@param data The block, not empty and not bigger than MAX_BLOCK.
+    ///@param size Size of the block.
+    ///@param out Where the block is appended.
+    //////////////////////////////////////////////////////
+    static void writeBlock(const char* data, size_t size, std::string& out);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Append the end of a compressed file.
+    ///
+    ///@param out Where the end is appended.
+    //////////////////////////////////////////////////////
+    static void writeEnd(std::string& out);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Check if data is a compressed file.
+    ///
+    ///@param data The contents of a file.
+    ///@return True if data starts with the header written by writeHeader().
+    //////////////////////////////////////////////////////
+    static bool isCompressed(std::string_view data);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Decompress a whole compressed file. If the file is damaged, throw an exception.
+    ///
+    ///@param data The contents of the file.
+    ///@param threads Number of threads, 0 to choose it by the size of the file and the number of cores.
+    ///@return The decompressed contents.
+    //////////////////////////////////////////////////////
+    static std::string decompressFile(std::string_view data, size_t threads = 0);
+};
@@ -225,6 +225,41 @@ public:
     //////////////////////////////////////////////////////
     size_t getSpacing() override;
 
+
+    //////////////////////////////////////////////////////
+    ///@brief Convert double to the shortest string which is read back as the same double.
+    ///
+    ///@param value Random variable of type double.
+    ///@return The value in form for read/write from/to file.
+    //////////////////////////////////////////////////////
+    static std::string format(double value);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief The size of a buffer which fits every double formatted by format().
+    ///
+    //////////////////////////////////////////////////////
+    static const size_t FORMAT_SIZE = 330;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Convert double to the shortest string which is read back as the same double, without
+    ///       allocating memory. Scientific notation is not used, so the string may be long.
+    ///@param value Random variable of type double.
+    ///@param buffer Buffer of at least FORMAT_SIZE chars. Not null-terminated.
+    ///@return The number of chars written.
+    //////////////////////////////////////////////////////
+    static size_t format(double value, char* buffer);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the size of a double converted by format().
+    ///
+    ///@param value Random variable of type double.
+    ///@return The same as format(value).size().
+    //////////////////////////////////////////////////////
+    static size_t width(double value);
+
 };
 
 
@@ -244,10 +279,10 @@ private:
     std::string value;
 
     //////////////////////////////////////////////////////
-    ///@brief The value of the stringCell in form for read/write from/to file.
-    ///       Every \ and " symbol are displayed by \\ or \" respectively.
+    ///@brief The value converted to double once, when the stringCell is constructed.
+    ///
     //////////////////////////////////////////////////////
-    std::string s_value; //the value in C/C++ string form
+    double num_value;
 
 public:
 
@@ -278,15 +313,27 @@ public:
     //////////////////////////////////////////////////////
     ///@brief Get the s_value of the stringCell.
     ///
-    ///@return The value of the cell in form for read/write from/to file. 
+    ///@return The value of the cell in form for read/write from/to file,
+    ///        produced from the value with escape().
     //////////////////////////////////////////////////////
     std::string getS_Value() const override;
 
 
+    //////////////////////////////////////////////////////
+    ///@brief Turn a string into the form for read/write from/to file.
+    ///       It is surrounded by quotations and every \ and " symbol are displayed by \\ or \" respectively.
+    ///
+    ///@param value The string.
+    ///@param size The length of the string.
+    ///@return The s_value of the string.
+    //////////////////////////////////////////////////////
+    static std::string escape(const char* value, size_t size);
+
+
     //////////////////////////////////////////////////////
     ///@brief Get the number value of the stringCell.
     ///
-    ///@return std::stod(value) or 0 if std::stod throws an exception.          
+    ///@return std::stod(value) or 0 if std::stod throws an exception. Calculated in the constructor.
     //////////////////////////////////////////////////////
     double getNum_Value() override;
 
@@ -0,0 +1,54 @@
+#pragma once
+#include "cell.h"
+#include <cstdint>
+
+
+class formulaCell;
+
+
+//////////////////////////////////////////////////////
+///@brief The value of one cell as it is stored in the table: a type tag
+///       and a 8-byte payload, 16 bytes in total. Numbers are stored directly,
+///       strings and formulas are owned by the table and only referred to.
+///       The Cell classes are used as a view on top of it (see Table::getCell()).
+//////////////////////////////////////////////////////
+struct CellValue {
+
+    //////////////////////////////////////////////////////
+    ///@brief Which member of the union is valid.
+    ///
+    //////////////////////////////////////////////////////
+    Type type;
+
+    union {
+        int integer;          //Type::INT
+        double number;        //Type::DOUBLE
+        uint32_t string;      //Type::STRING, index of the string in the table
+        formulaCell* formula; //Type::FORMULA, owned by the table
+    };
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct an empty cell value.
+    ///
+    //////////////////////////////////////////////////////
+    CellValue() : type(Type::EMPTY), number(0) {}
+
+    explicit CellValue(int integer) : type(Type::INT), integer(integer) {}
+
+    explicit CellValue(double number) : type(Type::DOUBLE), number(number) {}
+
+    explicit CellValue(formulaCell* formula) : type(Type::FORMULA), formula(formula) {}
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a string cell value.
+    ///
+    ///@param string Index of the string in the table.
+    //////////////////////////////////////////////////////
+    static CellValue ofString(uint32_t string)
+    {
+        CellValue value;
+        value.type = Type::STRING;
+        value.string = string;
+        return value;
+    }
+};
@@ -1,5 +1,8 @@
 #pragma once
 #include "table.h"
+#include "journal.h"
+#include <thread>
+#include <atomic>
 
 
 //////////////////////////////////////////////////////
@@ -25,10 +28,42 @@ private:
     std::string path;
 
     //////////////////////////////////////////////////////
-    ///@brief False if changes are made and not saved yet.
+    ///@brief Incremented by every edit. The data is saved if savedVersion is equal to it.
     ///
     //////////////////////////////////////////////////////
-    bool dataSaved;
+    size_t version;
+
+    //////////////////////////////////////////////////////
+    ///@brief The version which is saved in the document.
+    ///
+    //////////////////////////////////////////////////////
+    size_t savedVersion;
+
+    //////////////////////////////////////////////////////
+    ///@brief Writes a snapshot of the table in the background (see SAVE()). Not joinable if no save is running.
+    ///
+    //////////////////////////////////////////////////////
+    std::thread saving;
+
+    //////////////////////////////////////////////////////
+    ///@brief Set by the saving thread when it is finished.
+    ///
+    //////////////////////////////////////////////////////
+    std::atomic <bool> savingDone;
+
+    //////////////////////////////////////////////////////
+    ///@brief The path, the version and the error message (empty on success) of the running save.
+    ///       Only the saving thread uses them until it is joined.
+    //////////////////////////////////////////////////////
+    std::string savingPath;
+    size_t savingVersion;
+    std::string savingError;
+
+    //////////////////////////////////////////////////////
+    ///@brief The log of the edits if the journal mode is on, nullptr otherwise.
+    ///
+    //////////////////////////////////////////////////////
+    Journal* journal;
 
 public:
 
@@ -74,10 +109,12 @@ public:
 
     //////////////////////////////////////////////////////
     ///@brief Close the old document if there is such and open a document. If there is problem with the data types, show what is wrong.
-    ///
+    ///       If the document has a journal, the edits in it are applied and the journal mode is turned on.
     ///@param path Path to a document.
+    ///@param lazy True to read the rows when they are used (see Table(std::unique_ptr<MappedFile>)).
+    ///            The problems with the data types are shown when the rows are read.
     //////////////////////////////////////////////////////
-    void OPEN(const std::string& path);
+    void OPEN(const std::string& path, bool lazy = false);
 
 
     //////////////////////////////////////////////////////
@@ -89,21 +126,52 @@ public:
 
     //////////////////////////////////////////////////////
     ///@brief Save data to the document path leads to. If path does not lead anywhere, throw an exception.
-    ///       If there is no current document, throw an exception.
-    ///
+    ///       If there is no current document, throw an exception. In journal mode only the new edits are saved.
+    ///       Otherwise a snapshot of the table is written on another thread and the result is shown by reportSave().
     //////////////////////////////////////////////////////
     void SAVE();
 
 
     //////////////////////////////////////////////////////
     ///@brief Save the document to a new path. If the chosen path leads to already existing file, ask whether to overwrite it or not.
-    ///       If there is no current document, throw an exception.
+    ///       If there is no current document, throw an exception. The file is written in the background like in SAVE().
     ///
     ///@param path Path to file. May be unexisting one.
     //////////////////////////////////////////////////////
     void SAVEAS(const std::string& path);
 
 
+    //////////////////////////////////////////////////////
+    ///@brief Turn the journal mode on or off. In journal mode SAVE only appends the edits to <path>.journal.
+    ///       If there is no current document or it has no path, throw an exception.
+    ///
+    ///@param on True to turn the journal mode on.
+    //////////////////////////////////////////////////////
+    void JOURNAL(bool on);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Save the whole document, so its journal is no longer needed and is deleted.
+    ///       If there is no current document or it has no path, throw an exception.
+    ///
+    //////////////////////////////////////////////////////
+    void COMPACT();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Show the result of the save running in the background, if it is finished.
+    ///
+    //////////////////////////////////////////////////////
+    void reportSave();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Wait for the save running in the background, if there is one, and show its result.
+    ///
+    //////////////////////////////////////////////////////
+    void waitForSave();
+
+
     //////////////////////////////////////////////////////
     ///@brief Close the current document and exit.
     ///
@@ -135,6 +203,22 @@ public:
     //////////////////////////////////////////////////////
     void PRINT();
 
+
+    //////////////////////////////////////////////////////
+    ///@brief Print only a range of the table, see Table::print(size_t, size_t, size_t, size_t).
+    ///       If there is no current document or the range is invalid, throw an exception.
+    ///@param range Two cell addresses separated by ':', such as A1:F50.
+    //////////////////////////////////////////////////////
+    void PRINT(const std::string& range);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Print a page of rows of the table, see Table::printPage().
+    ///       If there is no current document, throw an exception.
+    ///@param page The number of the page, starting from 1.
+    //////////////////////////////////////////////////////
+    void PRINT(size_t page);
+
     //////////////////////////////////////////////////////
     ///@brief Show all supported operations.
     ///
@@ -152,4 +236,31 @@ private:
     //////////////////////////////////////////////////////
     void readCellAddress(const std::string& cellAddress, char& col, size_t& row);
 
+
+    //////////////////////////////////////////////////////
+    ///@brief Check if all edits are saved.
+    ///
+    ///@return True if there are no unsaved changes.
+    //////////////////////////////////////////////////////
+    bool isSaved() const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Start writing a snapshot of the whole document in the background (see write()).
+    ///       A save which is already running is waited for first.
+    ///
+    ///@param path Path to the file.
+    //////////////////////////////////////////////////////
+    void startSave(const std::string& path);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Write a whole table to a file, in the format chosen by the extension (.sheet, .csvz, .sheetz or text).
+    ///       The journal of the file is deleted, because it is already applied.
+    ///
+    ///@param path Path to the file.
+    ///@param table The table to write.
+    //////////////////////////////////////////////////////
+    static void write(const std::string& path, Table& table);
+
 };
\ No newline at end of file
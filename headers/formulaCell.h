@@ -6,6 +6,33 @@
 class Table;
 
 
+//////////////////////////////////////////////////////
+///@brief One step of a compiled formula. Formulas are compiled once into
+///       Reverse Polish Notation, so calculating them never re-reads the text.
+///
+//////////////////////////////////////////////////////
+struct Instruction {
+
+    //////////////////////////////////////////////////////
+    ///@brief What the instruction does with the evaluation stack.
+    ///
+    //////////////////////////////////////////////////////
+    enum class Kind : char {
+        NUMBER,    //pushes number
+        REFERENCE, //pushes the number value of the cell col/row
+        NEGATE,    //changes the sign of the top of the stack
+        OPERATOR   //pops two numbers and pushes op applied on them
+    };
+
+    Kind kind;
+    char op;
+    char col;
+    size_t row;
+    double number;
+};
+
+
+
 //////////////////////////////////////////////////////
 ///@brief Cell with a value of type formula.
 ///
@@ -40,10 +67,28 @@ private:
     Table* table;
 
     //////////////////////////////////////////////////////
-    ///@brief Vector which contains Cell** pointers to all cells which the current formulaCell depends on.
+    ///@brief The formula expression compiled to Reverse Polish Notation.
+    ///       Built once in the constructor.
+    //////////////////////////////////////////////////////
+    std::vector <Instruction> program;
+
+    //////////////////////////////////////////////////////
+    ///@brief False if the expression could not be compiled (e.g. a bad cell reference).
+    ///       Calculating such formula always fails.
+    //////////////////////////////////////////////////////
+    bool compiled;
+
+    //////////////////////////////////////////////////////
+    ///@brief True if result and result_string are outdated, because the formula
+    ///       or some of the cells it depends on has changed since the last calculation.
+    //////////////////////////////////////////////////////
+    bool dirty;
+
+    //////////////////////////////////////////////////////
+    ///@brief True if the last calculation failed. The result is shown as #ERROR.
     ///
     //////////////////////////////////////////////////////
-    std::vector <Cell**> dependingOn; 
+    bool failed;
 
 public:
 
@@ -56,6 +101,30 @@ public:
     formulaCell (const std::string& value, Table* ptr);
 
 
+    //////////////////////////////////////////////////////
+    ///@brief Construct a formula Cell object which is already compiled and calculated,
+    ///       e.g. read from a binary file (see Table::readBinary()).
+    ///
+    ///@param value Calculating expression in the form getS_Value() returns.
+    ///@param ptr Pointer to the table the current formulaCell is part of.
+    ///@param program The expression compiled by compile().
+    ///@param compiled False if the expression could not be compiled.
+    ///@param result The result of the last calculation.
+    ///@param failed True if the last calculation failed.
+    //////////////////////////////////////////////////////
+    formulaCell (const std::string& value, Table* ptr, std::vector<Instruction>&& program, bool compiled, double result, bool failed);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a copy of a formula for another table (see Table::snapshot()).
+    ///       The copy is calculated only if the original is.
+    ///
+    ///@param other The formula to copy.
+    ///@param ptr Pointer to the table the copy is part of.
+    //////////////////////////////////////////////////////
+    formulaCell (const formulaCell& other, Table* ptr);
+
+
     //////////////////////////////////////////////////////
     ///@brief Get the Type of the formulaCell object.
     ///
@@ -65,14 +134,15 @@ public:
 
 
     //////////////////////////////////////////////////////
-    ///@brief Print already calculated value of the formulaCell.
-    ///
+    ///@brief Print the result of the last calculation, without calculating.
+    ///       Call getSpacing() or getNum_Value() first, or let the table recalculate.
     //////////////////////////////////////////////////////
     void print() const override;
 
 
     //////////////////////////////////////////////////////
     ///@brief Get the spacing required for printing the calculated value of the formulaCell object.
+    ///       A dirty formula is calculated first, see calculateIfDirty().
     ///
     ///@return The spacing required for printing the calculated value of the formulaCell object.
     //////////////////////////////////////////////////////
@@ -80,7 +150,25 @@ public:
 
 
     //////////////////////////////////////////////////////
-    ///@brief Get the result of the expression calculation of formulaCell's value 
+    ///@brief Get the spacing required for printing the last calculated value, without calculating it.
+    ///
+    ///@return The spacing of the last result, 0 if the formula is not calculated yet.
+    //////////////////////////////////////////////////////
+    size_t getWidth() const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the last calculated value as it is printed, without calculating it.
+    ///
+    ///@return The last result, "#ERROR" if it failed.
+    //////////////////////////////////////////////////////
+    const std::string& getResult_String() const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the result of the expression calculation of formulaCell's value.
+    ///       The result is stored, so the formula is calculated again only if it is dirty
+    ///       (see calculateIfDirty()). Throws if the calculation fails.
     ///
     ///@return The result of the expression calculation of formulaCell's value
     //////////////////////////////////////////////////////
@@ -94,49 +182,82 @@ public:
     //////////////////////////////////////////////////////
     std::string getS_Value() const override; 
 
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the calculating expression without copying it.
+    ///
+    ///@return The same as getS_Value().
+    //////////////////////////////////////////////////////
+    const std::string& getValue() const;
+
     
     //////////////////////////////////////////////////////
-    ///@brief Re-fills the vector containing pointers to the cells which the current cell depends on. 
+    ///@brief Mark the result of the formula as outdated.
     ///
     //////////////////////////////////////////////////////
-    void fill_dependingOn();
+    void markDirty();
 
 
     //////////////////////////////////////////////////////
-    ///@brief Get the vector containing pointers to the cells which the current cell depends on.
+    ///@brief Check if the result of the formula is outdated.
     ///
-    ///@return Const reference to the vector containing pointers to the cells which the current cell depends on.
+    ///@return True if the formula has to be calculated again.
     //////////////////////////////////////////////////////
-    const std::vector<Cell**>& getDependingOn();
+    bool isDirty() const;
 
 
     //////////////////////////////////////////////////////
-    ///@brief In some cases there may occur infinite recursion (infinite cell referencing)
-    ///       which leads to crash. Check if the current formulaCell is such case.
-    ///       If yes, throw an exception... This method is recursive itself, checking
-    ///       the cell-depending graph.
+    ///@brief Check if the last calculation of the formula failed.
     ///
-    ///@param cell Pointer to the cell we check in the moment.
-    ///@param forbiddenCells If the dependingOn vector of the current cell has any common members with this vector, infinite cell referencing is found.
+    ///@return True if the result of the formula is #ERROR.
     //////////////////////////////////////////////////////
-    void checkForRecursion(formulaCell* cell, std::vector<Cell*>& forbiddenCells); 
-    
-    
+    bool isFailed() const;
+
+
     //////////////////////////////////////////////////////
-    ///@brief Calculate the formulaCell expression value.
+    ///@brief Check if the expression could be compiled.
     ///
-    ///@return The result of the formulaCell expression value in type double. 
+    ///@return False if calculating the formula always fails.
     //////////////////////////////////////////////////////
-    double calculate();
+    bool isCompiled() const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Calculate the formula again and store the result (or #ERROR) for printing.
+    ///       The cells it depends on must not be dirty, except if the formula is not part of the table.
+    //////////////////////////////////////////////////////
+    void refresh();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief If the formula is dirty, let its table recalculate the dirty formulas, so the cells it
+    ///       depends on are calculated first. A formula which is not part of a table is refreshed alone.
+    //////////////////////////////////////////////////////
+    void calculateIfDirty();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Store #ERROR as a result without calculating. Used for formulas
+    ///       which are part of infinite cell referencing.
+    //////////////////////////////////////////////////////
+    void markFailed();
 
 
     //////////////////////////////////////////////////////
-    ///@brief The original expression value may contain some references to other cells... 
-    ///       Check that and replace these cell references with the respective double type values.
+    ///@brief Get the compiled form of the formula expression.
     ///
-    ///@return An only number-and-operator expression which can be calculated by shunting yard algorithm. 
+    ///@return Const reference to the formula expression in Reverse Polish Notation.
     //////////////////////////////////////////////////////
-    std::string getCalculationExpression();
+    const std::vector<Instruction>& getProgram() const;
+
+
+    //////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////
+    ///@brief Calculate the formulaCell expression value.
+    ///
+    ///@return The result of the formulaCell expression value in type double. 
+    //////////////////////////////////////////////////////
+    double calculate();
 
 
     //////////////////////////////////////////////////////
@@ -175,5 +296,27 @@ public:
     ///@return The result of the calculation of the expression. 
     //////////////////////////////////////////////////////
     static double shuntingYard(const std::string& exp);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Shunting Yard algorithm. Compile an expression to Reverse Polish Notation.
+    ///       A '+' or '-' right after another operator is the sign of the next operand.
+    ///       Throws std::invalid_argument if the expression is malformed.
+    ///
+    ///@param exp Expression of numbers, cell references and operators.
+    ///@param from The position in exp the expression starts from.
+    ///@return The expression in Reverse Polish Notation.
+    //////////////////////////////////////////////////////
+    static std::vector<Instruction> compile(const std::string& exp, size_t from = 0);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Execute a compiled expression. Throws if there is division by 0.
+    ///       The values of the referenced cells are used directly as double.
+    ///@param program Expression in Reverse Polish Notation, made by compile().
+    ///@param table The table cell references point to. Cell references count as 0 if it is nullptr.
+    ///@return The result of the calculation of the expression.
+    //////////////////////////////////////////////////////
+    static double execute(const std::vector<Instruction>& program, Table* table);
     
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include "table.h"
+#include <string>
+
+
+//////////////////////////////////////////////////////
+///@brief Append-only log of the edits of a document, kept next to it in <path>.journal.
+///       Opening the document replays the log over it, so saving only has to append
+///       the new edits instead of writing the whole document again.
+//////////////////////////////////////////////////////
+class Journal {
+
+private:
+
+    //////////////////////////////////////////////////////
+    ///@brief Path leading to the log file.
+    ///
+    //////////////////////////////////////////////////////
+    std::string path;
+
+    //////////////////////////////////////////////////////
+    ///@brief The records of the edits which are not saved yet.
+    ///
+    //////////////////////////////////////////////////////
+    std::string pending;
+
+public:
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a new Journal object for a document. The log file is created
+    ///       the first time something is saved, the existing one is appended to.
+    ///
+    ///@param documentPath Path leading to the document.
+    //////////////////////////////////////////////////////
+    Journal (const std::string& documentPath);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Record an edit. It is written to the log by sync().
+    ///
+    ///@param col The column of the edited cell.
+    ///@param row The row of the edited cell.
+    ///@param newValue The new value, as Table::setValue() accepts it.
+    //////////////////////////////////////////////////////
+    void append (char col, size_t row, const std::string& newValue);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Append the recorded edits to the log and flush it to the disk.
+    ///
+    //////////////////////////////////////////////////////
+    void sync();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the path of the log of a document.
+    ///
+    ///@param documentPath Path leading to the document.
+    ///@return documentPath + ".journal"
+    //////////////////////////////////////////////////////
+    static std::string pathOf (const std::string& documentPath);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Apply the edits in the log of a document to the table. An unfinished
+    ///       record at the end (e.g. after a crash while saving) is ignored.
+    ///
+    ///@param documentPath Path leading to the document.
+    ///@param table The table read from the document.
+    ///@return Number of replayed edits, 0 if there is no log.
+    //////////////////////////////////////////////////////
+    static size_t replay (const std::string& documentPath, Table& table);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Delete the log of a document, e.g. after the whole document is saved.
+    ///
+    ///@param documentPath Path leading to the document.
+    //////////////////////////////////////////////////////
+    static void remove (const std::string& documentPath);
+};
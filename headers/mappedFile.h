@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+
+//////////////////////////////////////////////////////
+///@brief Read-only view of a whole file. On POSIX systems the file is mapped
+///       into memory with mmap, so it is read without being copied. Otherwise
+///       (or if mmap fails) the file is read into a buffer.
+//////////////////////////////////////////////////////
+class MappedFile {
+
+private:
+
+    //////////////////////////////////////////////////////
+    ///@brief The contents of the file.
+    ///
+    //////////////////////////////////////////////////////
+    const char* data;
+    size_t size;
+
+    //////////////////////////////////////////////////////
+    ///@brief True if data points to a mapping which has to be unmapped.
+    ///
+    //////////////////////////////////////////////////////
+    bool mapped;
+
+    //////////////////////////////////////////////////////
+    ///@brief The contents of the file if it is not mapped.
+    ///
+    //////////////////////////////////////////////////////
+    std::string buffer;
+
+public:
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a new MappedFile object.
+    ///
+    ///@param path Path leading to the file.
+    ///@throw std::runtime_error if the file cannot be opened.
+    //////////////////////////////////////////////////////
+    MappedFile (const std::string& path);
+
+    MappedFile (const MappedFile&) = delete;
+
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    //////////////////////////////////////////////////////
+    ///@brief Unmap the file.
+    ///
+    //////////////////////////////////////////////////////
+    ~MappedFile();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the contents of the file.
+    ///
+    ///@return View valid until the MappedFile is destroyed.
+    //////////////////////////////////////////////////////
+    std::string_view getData() const;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+
+//////////////////////////////////////////////////////
+///@brief Finds a symbol which matters to the file format (a delimiter, quote,
+///       backslash or new line) 64 bytes at a time with SSE2/AVX2 instructions,
+///       or one by one if neither is available.
+//////////////////////////////////////////////////////
+class Scanner {
+
+private:
+
+    //////////////////////////////////////////////////////
+    ///@brief The scanned data.
+    ///
+    //////////////////////////////////////////////////////
+    std::string_view data;
+
+    //////////////////////////////////////////////////////
+    ///@brief The symbol which is looked for.
+    ///
+    //////////////////////////////////////////////////////
+    char symbol;
+
+    //////////////////////////////////////////////////////
+    ///@brief The position of the current block in data.
+    ///
+    //////////////////////////////////////////////////////
+    size_t block;
+
+    //////////////////////////////////////////////////////
+    ///@brief The positions in the current block which are not returned by next() yet.
+    ///
+    //////////////////////////////////////////////////////
+    uint64_t mask;
+
+public:
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a new Scanner object.
+    ///
+    ///@param data The data to scan. Must be valid while the scanner is used.
+    ///@param symbol The symbol to look for.
+    //////////////////////////////////////////////////////
+    Scanner (std::string_view data, char symbol);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Find the next position of the symbol.
+    ///
+    ///@return The position in data, data.size() if there are no more.
+    //////////////////////////////////////////////////////
+    size_t next();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Find one symbol in a block.
+    ///
+    ///@param data The block.
+    ///@param size Size of the block, at most 64.
+    ///@param symbol The symbol to look for. Must not be '\0'.
+    ///@return Bit i is set if byte i is the symbol.
+    //////////////////////////////////////////////////////
+    static uint64_t scan (const char* data, size_t size, char symbol);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the index of the lowest set bit of a mask, e.g. the position of the first symbol.
+    ///
+    ///@param mask The mask. Must not be 0.
+    ///@return The index of the bit.
+    //////////////////////////////////////////////////////
+    static size_t lowestBit (uint64_t mask);
+};
@@ -1,7 +1,15 @@
 #pragma once
 #include "cell.h"
+#include "cellValue.h"
 #include "formulaCell.h"
+#include "arena.h"
+#include "mappedFile.h"
+#include "widthHistogram.h"
 #include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
 #include <fstream>
 
 
@@ -14,10 +22,175 @@ class Table {
 private:
 
     //////////////////////////////////////////////////////
-    ///@brief Stores pointers to all cells in the table.
+    ///@brief The non-empty cells of one row. Empty cells are not stored.
     ///
     //////////////////////////////////////////////////////
-    std::vector < std::vector <Cell*> > cells;
+    struct Row {
+        uint64_t occupied = 0;            //bit j is set if column j < MASK_COLUMNS has a non-empty value
+        CellValue* values = nullptr;      //the non-empty values, in column order, allocated by the arena
+        uint32_t capacity = 0;            //how many values fit in the allocated memory
+        uint32_t wideCount = 0;           //number of non-empty values in the columns after MASK_COLUMNS, they are the last values
+        uint32_t* wideColumns = nullptr;  //the columns of these values, in order, allocated by the arena
+    };
+
+    //////////////////////////////////////////////////////
+    ///@brief Number of columns which are marked in Row::occupied. The rare wider rows keep
+    ///       the columns of the rest of their values in Row::wideColumns.
+    //////////////////////////////////////////////////////
+    static const size_t MASK_COLUMNS = 64;
+
+    //////////////////////////////////////////////////////
+    ///@brief The maximum number of columns of a row.
+    ///
+    //////////////////////////////////////////////////////
+    static const size_t MAX_COLUMNS = 1 << 16;
+
+    //////////////////////////////////////////////////////
+    ///@brief Number of consecutive rows stored together in a RowBlock.
+    ///
+    //////////////////////////////////////////////////////
+    static const size_t BLOCK_ROWS = 256;
+
+    //////////////////////////////////////////////////////
+    ///@brief Files smaller than this (in bytes) are parsed by one thread.
+    ///
+    //////////////////////////////////////////////////////
+    static const size_t PARALLEL_SIZE = 1 << 20;
+
+    //////////////////////////////////////////////////////
+    ///@brief Number of rows printed by printPage().
+    ///
+    //////////////////////////////////////////////////////
+    static const size_t PAGE_ROWS = 50;
+
+    //////////////////////////////////////////////////////
+    ///@brief The rendered table is written when the buffer grows to this size (in bytes).
+    ///
+    //////////////////////////////////////////////////////
+    static const size_t RENDER_SIZE = 1 << 20;
+
+    //////////////////////////////////////////////////////
+    ///@brief A row which is parsed but not added to the table yet.
+    ///       Strings are not in the string pool yet, CellValue of type STRING holds an index in texts.
+    //////////////////////////////////////////////////////
+    struct ParsedRow {
+        std::vector <CellValue> values;        //the non-empty values, in column order
+        std::vector <uint32_t> valueColumns;   //the column of every value
+        std::vector <std::string_view> texts;  //the strings in form for read/write from/to file
+        size_t columns;                        //number of columns, including the empty ones
+    };
+
+    //////////////////////////////////////////////////////
+    ///@brief Consecutive lines of a file parsed by one thread (see readFromBuffer() and readRows()).
+    ///
+    //////////////////////////////////////////////////////
+    struct ParsedChunk {
+        struct RowInfo {
+            uint32_t count;
+            uint32_t textCount;
+            size_t columns;
+        };
+
+        std::string_view data;                 //the lines
+        std::vector <RowInfo> rows;            //the parsed rows, their values and texts are next to each other
+        std::vector <CellValue> values;
+        std::vector <uint32_t> valueColumns;
+        std::vector <std::string_view> texts;
+        std::vector <uint32_t> widths;         //the widths of the numbers (see widthOf()), 0 for the other values
+        bool failed = false;                   //true if failedLine could not be parsed, the next lines are not parsed
+        std::string_view failedLine;
+    };
+
+    //////////////////////////////////////////////////////
+    ///@brief BLOCK_ROWS consecutive rows of the table.
+    ///
+    //////////////////////////////////////////////////////
+    struct RowBlock {
+        Row rows[BLOCK_ROWS];
+    };
+
+    //////////////////////////////////////////////////////
+    ///@brief Allocates the blocks, the rows' values and the strings of the table.
+    ///       Everything is freed at once when the table is destroyed.
+    //////////////////////////////////////////////////////
+    Arena arena;
+
+    //////////////////////////////////////////////////////
+    ///@brief Stores the cells of the table. Block i contains rows i*BLOCK_ROWS+1 ... (i+1)*BLOCK_ROWS.
+    ///       Blocks without any non-empty cell are nullptr.
+    //////////////////////////////////////////////////////
+    std::vector <RowBlock*> blocks;
+
+    //////////////////////////////////////////////////////
+    ///@brief Stores the number of rows of the table, including the empty ones.
+    ///
+    //////////////////////////////////////////////////////
+    size_t rowCount;
+
+    //////////////////////////////////////////////////////
+    ///@brief The file of a lazily opened table (see Table(std::unique_ptr<MappedFile>)).
+    ///       nullptr if the table is not opened lazily or all rows are read by readRows().
+    //////////////////////////////////////////////////////
+    std::unique_ptr <MappedFile> source;
+
+    //////////////////////////////////////////////////////
+    ///@brief blockOffsets[i] is the offset in source of the first line of block i.
+    ///
+    //////////////////////////////////////////////////////
+    std::vector <size_t> blockOffsets;
+
+    //////////////////////////////////////////////////////
+    ///@brief blockRead[i] is true if block i of source is already stored.
+    ///
+    //////////////////////////////////////////////////////
+    std::vector <bool> blockRead;
+
+    //////////////////////////////////////////////////////
+    ///@brief A distinct string cell value. The characters are allocated by the arena.
+    ///
+    //////////////////////////////////////////////////////
+    struct StoredString {
+        const char* value;   //the value without the quotes and escaping backslashes
+        uint32_t size;
+        uint32_t references; //number of cells with the string, 0 if the entry is free
+        double num_value;    //see stringCell::getNum_Value()
+    };
+
+    //////////////////////////////////////////////////////
+    ///@brief The string pool. CellValue of type STRING holds an index in this vector.
+    ///       Every distinct string is stored once, equal string cells share the index.
+    //////////////////////////////////////////////////////
+    std::vector <StoredString> strings;
+
+    //////////////////////////////////////////////////////
+    ///@brief The indexes of the free entries of the pool, reused by the next new strings.
+    ///
+    //////////////////////////////////////////////////////
+    std::vector <uint32_t> freeStrings;
+
+    //////////////////////////////////////////////////////
+    ///@brief The index of every string in the pool, by its unescaped value.
+    ///
+    //////////////////////////////////////////////////////
+    std::unordered_map <std::string_view, uint32_t> stringIndex;
+
+    //////////////////////////////////////////////////////
+    ///@brief All formulas of the table. They are the only cells which are not allocated by the arena.
+    ///
+    //////////////////////////////////////////////////////
+    std::unordered_set <formulaCell*> formulas;
+
+    //////////////////////////////////////////////////////
+    ///@brief The parsed row of addRow(), kept between the calls so its vectors are allocated once.
+    ///
+    //////////////////////////////////////////////////////
+    ParsedRow parsedRow;
+
+    //////////////////////////////////////////////////////
+    ///@brief The Cell object returned by the last call of getCell() for numbers and empty cells.
+    ///
+    //////////////////////////////////////////////////////
+    std::unique_ptr <Cell> view;
 
     //////////////////////////////////////////////////////
     ///@brief Stores width of the columns so the table can be printed aligned.
@@ -25,12 +198,43 @@ private:
     //////////////////////////////////////////////////////
     std::vector <unsigned> spacing;
 
+    //////////////////////////////////////////////////////
+    ///@brief The buffer the table is rendered into before it is written, kept between the prints.
+    ///
+    //////////////////////////////////////////////////////
+    std::string rendered;
+
+    //////////////////////////////////////////////////////
+    ///@brief The widths of the stored cells of every column (see widthOf()), counted when a cell is
+    ///       stored, changed or calculated, so align() does not visit the cells.
+    //////////////////////////////////////////////////////
+    std::vector <WidthHistogram> columnWidths;
+
     //////////////////////////////////////////////////////
     ///@brief Stores the size of the longest row of the table.
     ///
     //////////////////////////////////////////////////////
     size_t longestRow;
 
+    //////////////////////////////////////////////////////
+    ///@brief The reverse dependency edges. For every cell address (see address())
+    ///       stores the addresses of the formulas which refer to it.
+    ///       The forward edges are the cell references in the formulas' compiled programs.
+    //////////////////////////////////////////////////////
+    std::unordered_map <size_t, std::vector<size_t> > dependents;
+
+    //////////////////////////////////////////////////////
+    ///@brief Addresses of the formulas marked dirty since the last recalculation.
+    ///
+    //////////////////////////////////////////////////////
+    std::vector <size_t> toRecalculate;
+
+    //////////////////////////////////////////////////////
+    ///@brief True while recalculate() is running.
+    ///
+    //////////////////////////////////////////////////////
+    bool recalculating;
+
 public:
 
     //////////////////////////////////////////////////////
@@ -48,6 +252,30 @@ public:
     Table(std::ifstream& file);
 
 
+    //////////////////////////////////////////////////////
+    ///@brief Construct a new Table object with already added data.
+    ///
+    ///@param data The contents of a text, binary (see isBinary()) or compressed (see BlockCodec) file,
+    ///            e.g. MappedFile::getData().
+    //////////////////////////////////////////////////////
+    Table(std::string_view data);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a new Table object which reads the rows of a text file when they are used.
+    ///       Only the new lines are found at first, the rows are parsed in blocks of BLOCK_ROWS
+    ///       the first time a cell of the block is needed. Binary and compressed files are read at once.
+    ///       If a row contains a cell with unknown data type, the exception is thrown when the row is read.
+    ///
+    ///@param file The file. The table keeps it until all rows are read.
+    //////////////////////////////////////////////////////
+    Table(std::unique_ptr<MappedFile> file);
+
+    Table (const Table&) = delete;
+
+    Table& operator= (const Table&) = delete;
+
+
     //////////////////////////////////////////////////////
     ///@brief Destroy the Table object
     ///
@@ -58,13 +286,36 @@ public:
     //////////////////////////////////////////////////////
     ///@brief Print the aligned table.
     ///
+    ///@param fd File descriptor the table is written to, -1 for std::cout.
+    //////////////////////////////////////////////////////
+    void print(int fd = -1);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Print only the cells of a range. Only their formulas (and the formulas they refer to)
+    ///       are calculated, and the columns are as wide as the widest cell of the range.
+    ///       The range is cut to the table limits. If nothing is left of it, throw an exception.
+    ///@param firstColumn The first column of the range, starting from 0.
+    ///@param firstRow The first row of the range, starting from 1.
+    ///@param lastColumn The last column of the range, not before firstColumn.
+    ///@param lastRow The last row of the range, not before firstRow.
+    ///@param fd File descriptor the range is written to, -1 for std::cout.
     //////////////////////////////////////////////////////
-    void print();
+    void print(size_t firstColumn, size_t firstRow, size_t lastColumn, size_t lastRow, int fd = -1);
 
 
     //////////////////////////////////////////////////////
-    ///@brief Align the table.
+    ///@brief Print PAGE_ROWS rows with all their columns, see print(size_t, size_t, size_t, size_t).
     ///
+    ///@param page The number of the page, starting from 1.
+    ///@param fd File descriptor the page is written to, -1 for std::cout.
+    //////////////////////////////////////////////////////
+    void printPage(size_t page, int fd = -1);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Align the table. The dirty formulas are calculated first (see recalculate()),
+    ///       the widths are then only read from the calculated results.
     //////////////////////////////////////////////////////
     void align();
 
@@ -73,9 +324,9 @@ public:
     ///@brief Add a new row to the table. If the row contains a cell
     ///       with unknown data type, throw an exception with a message what is wrong.
     ///
-    ///@param row The new row.
+    ///@param row The new row. Only the cells which need it are copied.
     //////////////////////////////////////////////////////
-    void addRow (const std::string& row);
+    void addRow (std::string_view row);
 
 
     //////////////////////////////////////////////////////
@@ -89,13 +340,53 @@ public:
 
 
     //////////////////////////////////////////////////////
-    ///@brief Get double pointer to a cell.
+    ///@brief Get a cell in form of a Cell object.
     ///
     ///@param col The column of the cell we want to get access to. Must be upper case letter! May be out of the current table limits.
     ///@param row The row of the cell we want to get access to. Must be positive! May be out of the current table limits.
-    ///@return Pointer to poiner to a cell in the table or nullptr if the cell is out of the current table limits.
+    ///@return Pointer to the cell or nullptr if the cell is out of the current table limits. 
+    ///        Valid until the next call of getCell() or until the table is changed.
+    //////////////////////////////////////////////////////
+    Cell* getCell (char col, size_t row);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the number value of a cell directly from the stored value.
+    ///
+    ///@param column The column of the cell, starting from 0. May be out of the current table limits.
+    ///@param row The row of the cell, starting from 1. May be out of the current table limits.
+    ///@return The number value of the cell (see Cell::getNum_Value()), 0 if it is out of the table limits.
+    //////////////////////////////////////////////////////
+    double getNum_Value (size_t column, size_t row);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the key of a cell in the dependency graph.
+    ///
+    ///@param column The column of the cell, starting from 0.
+    ///@param row The row of the cell, starting from 1.
+    ///@return Number which is unique for every cell.
+    //////////////////////////////////////////////////////
+    static size_t address(size_t column, size_t row);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Calculate again only the formulas which are marked dirty. The strongly connected
+    ///       components of the dirty formulas are found first (Tarjan's algorithm), so every
+    ///       formula which is part of infinite cell referencing gets #ERROR without calculating
+    ///       and the rest are calculated once, after the formulas they depend on.
+    ///       If it throws (e.g. a lazily read row is damaged), the formulas not calculated yet
+    ///       stay dirty and are calculated when they are used.
     //////////////////////////////////////////////////////
-    Cell** getCell (char col, size_t row);
+    void recalculate();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Calculate again only some dirty formulas and the dirty formulas they refer to,
+    ///       in the same way as recalculate(). The rest stay marked dirty.
+    ///@param roots Addresses of the formulas. Clean formulas and other cells are skipped.
+    //////////////////////////////////////////////////////
+    void recalculate(const std::vector<size_t>& roots);
 
 
     //////////////////////////////////////////////////////
@@ -106,12 +397,77 @@ public:
     void readFromFile (std::ifstream& file);
 
 
+    //////////////////////////////////////////////////////
+    ///@brief Read data from the contents of a file. Every line is a row.
+    ///       Big files are split at new lines and parsed by several threads.
+    ///@param data The contents of the file.
+    ///@param threads Number of threads, 0 to choose it by the size of the file and the number of cores.
+    //////////////////////////////////////////////////////
+    void readFromBuffer (std::string_view data, size_t threads = 0);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Copy the values of the table, e.g. to save them on another thread while this table is edited.
+    ///       The copy can be printed, calculated and saved, but it is not meant to be edited:
+    ///       it does not know which formulas depend on a cell, and equal strings added to it are not shared.
+    ///       Every stored cell, string and formula is copied, so it takes time and memory linear in their number.
+    ///       The rows of a lazily opened table are read first (see readRows()).
+    ///@return The copy. It does not share any memory with this table.
+    //////////////////////////////////////////////////////
+    std::unique_ptr<Table> snapshot();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Read all rows of a lazily opened table which are not read yet, on several threads if there are many.
+    ///       Afterwards the table does not need its file any more, so the file can be overwritten.
+    ///       If a row contains a cell with unknown data type, throw an exception with a message what is wrong.
+    //////////////////////////////////////////////////////
+    void readRows();
+
+
     //////////////////////////////////////////////////////
     ///@brief Save data in file.
     ///
     ///@param file File to save data in.
+    ///@param compressed True to compress the file with BlockCodec. The file must be opened in binary mode then.
+    //////////////////////////////////////////////////////
+    void saveInFile (std::ofstream& file, bool compressed = false);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Save data in the binary format: typed values, the string pool and the compiled
+    ///       formulas with their results, so reading it does not parse or calculate anything.
+    ///
+    ///@param file File opened in binary mode to save data in.
+    ///@param compressed True to compress the file with BlockCodec.
     //////////////////////////////////////////////////////
-    void saveInFile (std::ofstream& file);
+    void saveBinary (std::ofstream& file, bool compressed = false);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Read data saved by saveBinary().
+    ///
+    ///@param data The contents of the file.
+    ///@throw std::invalid_argument if the file is damaged.
+    //////////////////////////////////////////////////////
+    void readBinary (std::string_view data);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Read the contents of a text, binary or compressed file, see Table(std::string_view).
+    ///
+    ///@param data The contents of the file.
+    //////////////////////////////////////////////////////
+    void readData (std::string_view data);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Check if the contents of a file are in the binary format.
+    ///
+    ///@param data The contents of the file.
+    ///@return True if the data starts with the binary format's magic header.
+    //////////////////////////////////////////////////////
+    static bool isBinary (std::string_view data);
 
 
 
@@ -126,7 +482,19 @@ public:
     ///        4 for empty type ; 
     ///        5 for formula.
     //////////////////////////////////////////////////////
-    int whatIsThis(std::string& str);
+    static int whatIsThis(std::string& str);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Determine the type of a value which is not a formula and convert it if it is a number,
+    ///       in one pass over the usual numbers. The types are the same as whatIsThis() returns.
+    ///
+    ///@param str Random string which does not start with '='.
+    ///@param number Set to the number for int and double. Type::EMPTY if the number
+    ///              cannot be converted, e.g. because it is too big.
+    ///@return The same as whatIsThis().
+    //////////////////////////////////////////////////////
+    static int parseValue(std::string_view str, CellValue& number);
 
 private:
 
@@ -136,6 +504,273 @@ private:
     ///@param str Random string.
     ///@return True if ther string is formula type. 
     //////////////////////////////////////////////////////
-    bool isFormula(std::string& str);
+    static bool isFormula(std::string& str);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the type of a value which is not a formula.
+    ///
+    ///@param str Random string which does not start with '='.
+    ///@return The same as whatIsThis().
+    //////////////////////////////////////////////////////
+    static int typeOf(std::string_view str);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the formula on some address.
+    ///
+    ///@param key Address of a cell.
+    ///@return Pointer to the formula or nullptr if the cell is not a formula.
+    //////////////////////////////////////////////////////
+    formulaCell* formulaAt(size_t key);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the addresses of the cells a formula refers to, each of them only once.
+    ///
+    ///@param formula Random formula.
+    ///@return Sorted addresses of the cells referred by formula.
+    //////////////////////////////////////////////////////
+    static std::vector<size_t> referencesOf(const formulaCell* formula);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Add (or remove) the dependency edges of a formula to the graph.
+    ///
+    ///@param key Address of the formula.
+    ///@param formula The formula on that address.
+    //////////////////////////////////////////////////////
+    void addDependencies(size_t key, const formulaCell* formula);
+    void removeDependencies(size_t key, const formulaCell* formula);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief The value on some address has changed. Mark all formulas
+    ///       which depend on it, directly or not, as dirty.
+    ///
+    ///@param key Address of the changed cell.
+    //////////////////////////////////////////////////////
+    void markDependentsDirty(size_t key);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Store a new string cell. The string is added to the pool only if it is not there yet.
+    ///
+    ///@param s_value The string in form for read/write from/to file.
+    ///@return The cell value referring to the string in the pool.
+    //////////////////////////////////////////////////////
+    CellValue addString(std::string_view s_value);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Add a string to the pool if it is not there yet, and count one more reference to it.
+    ///       A new string takes a free entry first, and its characters if they fit.
+    ///@param value The string without the quotes and escaping backslashes.
+    ///@return The index of the string in the pool.
+    //////////////////////////////////////////////////////
+    uint32_t internString(std::string_view value);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Count one reference less to a string of the pool. The entry is freed when no cell has it.
+    ///
+    ///@param index The index of the string in the pool.
+    //////////////////////////////////////////////////////
+    void releaseString(uint32_t index);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Delete all formulas of the table.
+    ///
+    //////////////////////////////////////////////////////
+    void deleteFormulas();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Create a new formula of the table.
+    ///
+    ///@param value Valid formula expression.
+    ///@return The cell value referring to the formula.
+    //////////////////////////////////////////////////////
+    CellValue addFormula(const std::string& value);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get a row of the table. The block of the row is read first if it is not read yet (see readBlock()).
+    ///
+    ///@param row The row number, starting from 1.
+    ///@return Pointer to the row or nullptr if it has no non-empty cells.
+    //////////////////////////////////////////////////////
+    Row* findRow(size_t row);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Parse and store the rows of a block of a lazily opened table.
+    ///       If a row contains a cell with unknown data type, the block stays unread and an exception is thrown.
+    ///
+    ///@param block Index of the block, which is not read yet.
+    //////////////////////////////////////////////////////
+    void readBlock(size_t block);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the lines of a block of a lazily opened table.
+    ///
+    ///@param block Index of the block.
+    ///@return The lines, without the new line after the last one.
+    //////////////////////////////////////////////////////
+    std::string_view blockData(size_t block) const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Parse the lines of a chunk without changing the table. Stops at the first line which cannot be parsed.
+    ///
+    ///@param chunk The chunk, with data set.
+    //////////////////////////////////////////////////////
+    void parseChunk(ParsedChunk& chunk) const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Store the parsed rows of a chunk. If the chunk failed, the rows are not stored
+    ///       and the exception of the failed line is thrown.
+    ///
+    ///@param chunk The parsed chunk.
+    ///@param firstRow The row number of the first line of the chunk.
+    //////////////////////////////////////////////////////
+    void placeChunk(const ParsedChunk& chunk, size_t firstRow);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Delete the formulas of a parsed chunk which is not stored.
+    ///
+    //////////////////////////////////////////////////////
+    static void discard(const ParsedChunk& chunk);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get a non-empty cell of the table.
+    ///
+    ///@param column The column of the cell, starting from 0.
+    ///@param row The row of the cell, starting from 1.
+    ///@return Pointer to the stored value or nullptr if the cell is empty or out of the table limits.
+    //////////////////////////////////////////////////////
+    CellValue* find(size_t column, size_t row);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get a non-empty cell of a stored row.
+    ///
+    ///@param row The row.
+    ///@param column The column of the cell, starting from 0.
+    ///@return Pointer to the stored value or nullptr if the cell is empty.
+    //////////////////////////////////////////////////////
+    static CellValue* cellOf(Row& row, size_t column);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Parse a row without changing the table, so rows can be parsed by several threads at once.
+    ///       If the row contains a cell with unknown data type, throw an exception with a message what is wrong.
+    ///
+    ///@param row The row.
+    ///@param rowNum The row number used in the error messages.
+    ///@param parsed Where the row is parsed to. The formulas are not part of the table yet.
+    //////////////////////////////////////////////////////
+    void parseRow(std::string_view row, size_t rowNum, ParsedRow& parsed) const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Add a parsed row after the last row of the table.
+    ///
+    ///@param values The non-empty values of the row, see ParsedRow.
+    ///@param valueColumns The column of every value, in increasing order.
+    ///@param count Number of values.
+    ///@param columns Number of columns of the row, including the empty ones.
+    ///@param texts The strings the values of type STRING refer to.
+    //////////////////////////////////////////////////////
+    void appendRow(const CellValue* values, const uint32_t* valueColumns, uint32_t count, size_t columns, const std::string_view* texts);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Store a parsed row, see appendRow(). The row must not be stored yet.
+    ///
+    ///@param rowNum The row number, starting from 1. The number of rows grows if it is bigger.
+    ///@param widths The widths of the values if they are already measured, 0 for the ones which are not.
+    ///              nullptr if none is measured.
+    //////////////////////////////////////////////////////
+    void placeRow(size_t rowNum, const CellValue* values, const uint32_t* valueColumns, uint32_t count, size_t columns, const std::string_view* texts, const uint32_t* widths);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Store a row. The row must not be stored yet.
+    ///
+    ///@param row The row number, starting from 1.
+    ///@param newRow The non-empty cells of the row.
+    //////////////////////////////////////////////////////
+    void storeRow(size_t row, const Row& newRow);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get a cell for writing, adding it to its row if it was empty.
+    ///
+    ///@param column The column of the cell, starting from 0.
+    ///@param row The row of the cell, starting from 1.
+    ///@return Reference to the stored value. Type::EMPTY if the cell was empty.
+    //////////////////////////////////////////////////////
+    CellValue& insert(size_t column, size_t row);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Free the formula a cell value refers to, or release its string (see releaseString()).
+    ///
+    ///@param value Cell value which is being removed from the table.
+    //////////////////////////////////////////////////////
+    void release(const CellValue& value);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the spacing needed to print a cell value without calculating it.
+    ///
+    ///@param value Cell value of the table.
+    ///@return The spacing needed to print the value. For formulas, of their last result.
+    //////////////////////////////////////////////////////
+    size_t widthOf(const CellValue& value) const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Append a calculated cell value as it is printed.
+    ///
+    ///@param value Cell value of the table.
+    ///@param out Where the value is appended.
+    //////////////////////////////////////////////////////
+    void print(const CellValue& value, std::string& out) const;
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Print the calculated cells of a range with their column letters and row numbers.
+    ///       The rows are rendered into a buffer, which is written in large parts.
+    ///@param firstColumn The first column, starting from 0.
+    ///@param firstRow The first row, starting from 1.
+    ///@param lastRow The last row.
+    ///@param widths The width of every column of the range, starting from firstColumn.
+    ///@param fd File descriptor the range is written to, -1 for std::cout.
+    //////////////////////////////////////////////////////
+    void printRange(size_t firstColumn, size_t firstRow, size_t lastRow, const std::vector<unsigned>& widths, int fd);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Write the rendered part of the table and empty the buffer. If it cannot be written, throw an exception.
+    ///
+    ///@param fd File descriptor the buffer is written to, -1 for std::cout.
+    //////////////////////////////////////////////////////
+    void writeRendered(int fd);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the cell value in form for read/write from/to file.
+    ///
+    ///@param value Cell value of the table.
+    ///@return The s_value of the cell (see Cell::getS_Value()).
+    //////////////////////////////////////////////////////
+    std::string getS_Value(const CellValue& value);
 
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+
+
+//////////////////////////////////////////////////////
+///@brief How many cells of a column have every printing width, so the width
+///       of the column is known without visiting the cells, also after the
+///       widest cell is removed. Empty cells (width 0) are not counted.
+//////////////////////////////////////////////////////
+class WidthHistogram {
+
+private:
+
+    //////////////////////////////////////////////////////
+    ///@brief Widths below DENSE are counted in an array, the rest in a map.
+    ///
+    //////////////////////////////////////////////////////
+    static const uint32_t DENSE = 512;
+
+    //////////////////////////////////////////////////////
+    ///@brief counts[w] is the number of cells with width w < DENSE. Grows up to the biggest such width.
+    ///
+    //////////////////////////////////////////////////////
+    std::vector <size_t> counts;
+
+    //////////////////////////////////////////////////////
+    ///@brief The number of cells with every width >= DENSE.
+    ///
+    //////////////////////////////////////////////////////
+    std::map <uint32_t, size_t> wide;
+
+    //////////////////////////////////////////////////////
+    ///@brief The biggest counted width, 0 if no cell is counted.
+    ///
+    //////////////////////////////////////////////////////
+    uint32_t widest;
+
+public:
+
+    //////////////////////////////////////////////////////
+    ///@brief Construct a new WidthHistogram object without any cell.
+    ///
+    //////////////////////////////////////////////////////
+    WidthHistogram();
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Count a cell.
+    ///
+    ///@param width The printing width of the cell. 0 is ignored.
+    //////////////////////////////////////////////////////
+    void add(uint32_t width);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Stop counting a cell which was added with the same width.
+    ///
+    ///@param width The printing width the cell was added with. 0 is ignored.
+    //////////////////////////////////////////////////////
+    void remove(uint32_t width);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Count a cell with a new width instead of its old one.
+    ///
+    //////////////////////////////////////////////////////
+    void change(uint32_t from, uint32_t to);
+
+
+    //////////////////////////////////////////////////////
+    ///@brief Get the width of the column.
+    ///
+    ///@return The biggest counted width, 0 if no cell is counted.
+    //////////////////////////////////////////////////////
+    uint32_t max() const;
+};
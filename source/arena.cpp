@@ -0,0 +1,50 @@
+#include "../headers/arena.h"
+#include <cstdint>
+
+
+Arena::Arena(size_t chunkSize) : current(nullptr), end(nullptr), chunkSize(chunkSize)
+{}
+
+
+
+Arena::~Arena()
+{
+    for (size_t i=0; i<chunks.size(); ++i){
+        delete[] chunks[i];
+    }
+}
+
+
+
+void* Arena::allocate(size_t size, size_t alignment)
+{
+    uintptr_t aligned = (uintptr_t(current) + alignment - 1) & ~uintptr_t(alignment - 1);
+
+    if (!current || aligned + size > uintptr_t(end)){
+        //big allocations get a chunk of their own, so the current chunk can still be used
+        size_t newSize = size + alignment > chunkSize / 4 ? size + alignment : chunkSize;
+        char* chunk = new char[newSize];
+        chunks.push_back(chunk);
+        sizes.push_back(newSize);
+
+        aligned = (uintptr_t(chunk) + alignment - 1) & ~uintptr_t(alignment - 1);
+        if (newSize != chunkSize){
+            return reinterpret_cast<void*>(aligned);
+        }
+        end = chunk + newSize;
+    }
+
+    current = reinterpret_cast<char*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+}
+
+
+
+size_t Arena::getReserved() const
+{
+    size_t total = 0;
+    for (size_t i=0; i<sizes.size(); ++i){
+        total += sizes[i];
+    }
+    return total;
+}
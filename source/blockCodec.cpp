@@ -0,0 +1,361 @@
+#include "../headers/blockCodec.h"
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+
+
+namespace {
+
+//////////////////////////////////////////////////////
+///@brief The first bytes of a compressed file and the version of the format.
+///
+//////////////////////////////////////////////////////
+const char COMPRESSED_MAGIC[8] = {'S', 'H', 'E', 'E', 'T', 'L', 'Z', '4'};
+const uint32_t COMPRESSED_VERSION = 1;
+
+//////////////////////////////////////////////////////
+///@brief The limits of the LZ4 block format: matches are at least MIN_MATCH bytes long
+///       and at most MAX_OFFSET bytes back, the last LAST_LITERALS bytes are literals
+///       and no match starts in the last MATCH_LIMIT bytes.
+//////////////////////////////////////////////////////
+const size_t MIN_MATCH = 4;
+const size_t MAX_OFFSET = 65535;
+const size_t LAST_LITERALS = 5;
+const size_t MATCH_LIMIT = 12;
+
+//////////////////////////////////////////////////////
+///@brief The positions of the last sequences of 4 bytes are found by a hash table of 2^HASH_BITS entries.
+///
+//////////////////////////////////////////////////////
+const size_t HASH_BITS = 14;
+
+//////////////////////////////////////////////////////
+///@brief Files smaller than this are decompressed on one thread.
+///
+//////////////////////////////////////////////////////
+const size_t PARALLEL_SIZE = 1 << 20;
+
+
+[[noreturn]] void damaged()
+{
+    throw std::invalid_argument("Error: the file is damaged");
+}
+
+
+inline uint32_t read32(const char* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+
+inline size_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+
+//////////////////////////////////////////////////////
+///@brief Write the part of a length which does not fit in the token: 255 while it is bigger, then the rest.
+///
+//////////////////////////////////////////////////////
+inline void writeLength(size_t length, char*& out)
+{
+    for (; length >= 255; length -= 255){
+        *out++ = char(255);
+    }
+    *out++ = char(length);
+}
+
+
+//////////////////////////////////////////////////////
+///@brief Read the part of a length written by writeLength().
+///
+//////////////////////////////////////////////////////
+inline size_t readLength(const unsigned char* in, size_t size, size_t& read)
+{
+    size_t length = 0;
+    unsigned char byte;
+    do {
+        if (read >= size){
+            damaged();
+        }
+        byte = in[read++];
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+
+//////////////////////////////////////////////////////
+///@brief Write one sequence: a token, the literals and a match. The last sequence has no match (length 0).
+///
+//////////////////////////////////////////////////////
+inline void writeSequence(const char* literals, size_t literalCount, size_t offset, size_t matchLength, char*& out)
+{
+    char* token = out++;
+    size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+    *token = char(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+
+    if (literalCount >= 15){
+        writeLength(literalCount - 15, out);
+    }
+    std::memcpy(out, literals, literalCount);
+    out += literalCount;
+
+    if (matchLength){
+        *out++ = char(offset & 0xFF);
+        *out++ = char(offset >> 8);
+        if (matchCode >= 15){
+            writeLength(matchCode - 15, out);
+        }
+    }
+}
+
+
+inline void put32(uint32_t value, std::string& out)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}
+
+
+
+size_t BlockCodec::bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+
+
+size_t BlockCodec::compress(const char* data, size_t size, char* compressed)
+{
+    char* out = compressed;
+    size_t anchor = 0;
+
+    if (size >= MATCH_LIMIT){
+        //positions + 1, 0 means no position
+        std::vector <uint32_t> table(size_t(1) << HASH_BITS, 0);
+        size_t matchEnd = size - LAST_LITERALS;
+        size_t i = 0;
+
+        while (i + MATCH_LIMIT <= size){
+            uint32_t sequence = read32(data + i);
+            size_t h = hash(sequence);
+            size_t candidate = table[h];
+            table[h] = uint32_t(i + 1);
+
+            if (!candidate || i + 1 - candidate > MAX_OFFSET || read32(data + candidate - 1) != sequence){
+                //the longer nothing is found, the faster the data is skipped
+                i += 1 + ((i - anchor) >> 6);
+                continue;
+            }
+
+            size_t from = candidate - 1;
+            size_t length = MIN_MATCH;
+            while (i + length < matchEnd && data[from + length] == data[i + length]){
+                ++length;
+            }
+
+            writeSequence(data + anchor, i - anchor, i - from, length, out);
+            i += length;
+            anchor = i;
+        }
+    }
+
+    writeSequence(data + anchor, size - anchor, 0, 0, out);
+    return size_t(out - compressed);
+}
+
+
+
+void BlockCodec::decompress(const char* compressed, size_t size, char* data, size_t dataSize)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(compressed);
+    size_t read = 0;
+    size_t written = 0;
+
+    while (true){
+        if (read >= size){
+            damaged();
+        }
+        unsigned token = in[read++];
+
+        size_t literals = token >> 4;
+        if (literals == 15){
+            literals += readLength(in, size, read);
+        }
+        if (literals > size - read || literals > dataSize - written){
+            damaged();
+        }
+        std::memcpy(data + written, in + read, literals);
+        read += literals;
+        written += literals;
+
+        //the last sequence ends with its literals
+        if (read == size){
+            break;
+        }
+
+        if (size - read < 2){
+            damaged();
+        }
+        size_t offset = size_t(in[read]) | size_t(in[read + 1]) << 8;
+        read += 2;
+        if (offset == 0 || offset > written){
+            damaged();
+        }
+
+        size_t length = token & 15;
+        if (length == 15){
+            length += readLength(in, size, read);
+        }
+        length += MIN_MATCH;
+        if (length > dataSize - written){
+            damaged();
+        }
+
+        //a match may overlap the bytes it writes, then they are copied one by one
+        if (offset >= length){
+            std::memcpy(data + written, data + written - offset, length);
+        }
+        else {
+            for (size_t i=0; i<length; ++i){
+                data[written + i] = data[written + i - offset];
+            }
+        }
+        written += length;
+    }
+
+    if (written != dataSize){
+        damaged();
+    }
+}
+
+
+
+void BlockCodec::writeHeader(std::string& out)
+{
+    out.append(COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC));
+    put32(COMPRESSED_VERSION, out);
+}
+
+
+
+void BlockCodec::writeBlock(const char* data, size_t size, std::string& out)
+{
+    size_t begin = out.size();
+    put32(uint32_t(size), out);
+    put32(0, out);
+    out.resize(begin + 8 + bound(size));
+
+    size_t stored = compress(data, size, &out[begin + 8]);
+    if (stored >= size){
+        stored = size;
+        std::memcpy(&out[begin + 8], data, size);
+    }
+    out.resize(begin + 8 + stored);
+
+    uint32_t stored32 = uint32_t(stored);
+    std::memcpy(&out[begin + 4], &stored32, sizeof(stored32));
+}
+
+
+
+void BlockCodec::writeEnd(std::string& out)
+{
+    put32(0, out);
+    put32(0, out);
+}
+
+
+
+bool BlockCodec::isCompressed(std::string_view data)
+{
+    return data.size() >= sizeof(COMPRESSED_MAGIC) && data.substr(0, sizeof(COMPRESSED_MAGIC)) == std::string_view(COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC));
+}
+
+
+
+std::string BlockCodec::decompressFile(std::string_view data, size_t threads)
+{
+    if (!isCompressed(data) || data.size() < sizeof(COMPRESSED_MAGIC) + 4){
+        damaged();
+    }
+    if (read32(data.data() + sizeof(COMPRESSED_MAGIC)) != COMPRESSED_VERSION){
+        throw std::invalid_argument("Error: unsupported version of the compressed format");
+    }
+
+    //the blocks are found first, so every thread knows where its blocks are decompressed to
+    struct Block {
+        size_t from;
+        size_t size;
+        size_t to;
+        size_t dataSize;
+    };
+    std::vector <Block> blocks;
+    size_t read = sizeof(COMPRESSED_MAGIC) + 4;
+    size_t total = 0;
+    while (true){
+        if (data.size() - read < 8){
+            damaged();
+        }
+        size_t dataSize = read32(data.data() + read);
+        size_t size = read32(data.data() + read + 4);
+        read += 8;
+
+        if (dataSize == 0){
+            if (size != 0 || read != data.size()){
+                damaged();
+            }
+            break;
+        }
+        if (dataSize > MAX_BLOCK || size == 0 || size > dataSize || size > data.size() - read){
+            damaged();
+        }
+        blocks.push_back({read, size, total, dataSize});
+        read += size;
+        total += dataSize;
+    }
+
+    std::string result(total, '\0');
+    if (threads == 0){
+        threads = data.size() < PARALLEL_SIZE ? 1 : std::thread::hardware_concurrency();
+    }
+
+    std::atomic <size_t> next(0);
+    std::atomic <bool> failed(false);
+    auto work = [&data, &blocks, &result, &next, &failed](){
+        for (size_t i = next++; i < blocks.size() && !failed; i = next++){
+            const Block& block = blocks[i];
+            if (block.size == block.dataSize){
+                std::memcpy(&result[block.to], data.data() + block.from, block.size);
+                continue;
+            }
+            try {
+                decompress(data.data() + block.from, block.size, &result[block.to], block.dataSize);
+            } catch (...){
+                failed = true;
+            }
+        }
+    };
+
+    std::vector <std::thread> workers;
+    for (size_t i=1; i<threads && i<blocks.size(); ++i){
+        workers.emplace_back(work);
+    }
+    work();
+    for (size_t i=0; i<workers.size(); ++i){
+        workers[i].join();
+    }
+
+    if (failed){
+        damaged();
+    }
+    return result;
+}
@@ -1,4 +1,8 @@
 #include "../headers/cell.h"
+#include <charconv>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 
 
@@ -6,7 +10,8 @@
 
 intCell::intCell(int value) : value(value)
 {
-    s_value = std::to_string(value);
+    char buffer[16];
+    s_value.assign(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
 }
 
 Type intCell::getType() { return Type::INT; }
@@ -29,18 +34,8 @@ size_t intCell::getSpacing()
 
 //***************************doubleCell***************************//
 
-doubleCell::doubleCell(double value) : value(value) 
-{
-    s_value = std::to_string(value);
-    //Removing unnecessary '0'-s
-    while (s_value.back() == '0'){
-        s_value.pop_back();
-    }
-
-    if (s_value.back() == '.'){
-        s_value.pop_back();
-    }
-}
+doubleCell::doubleCell(double value) : value(value), s_value(format(value))
+{}
 
 Type doubleCell::getType() { return Type::DOUBLE; }
 
@@ -57,12 +52,53 @@ size_t doubleCell::getSpacing()
     return s_value.size();
 }
 
+std::string doubleCell::format(double value)
+{
+    char buffer[FORMAT_SIZE];
+    return std::string(buffer, format(value, buffer));
+}
+
+size_t doubleCell::format(double value, char* buffer)
+{
+    //the shortest text which is read back as the same double, never in scientific notation
+    return size_t(std::to_chars(buffer, buffer + FORMAT_SIZE, value, std::chars_format::fixed).ptr - buffer);
+}
+
+size_t doubleCell::width(double value)
+{
+    //most numbers have a few decimals: if value*10^p rounds to a whole number m and m/10^p is exactly
+    //value again, m with p decimals is the shortest text, and only the digits of m have to be counted
+    static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+    double magnitude = std::fabs(value);
+    for (size_t p=0; p<sizeof(POWERS)/sizeof(POWERS[0]) && magnitude < 1e15; ++p){
+        double whole = std::nearbyint(magnitude * POWERS[p]);
+        if (whole >= 1e15){
+            break;
+        }
+        if (whole / POWERS[p] != magnitude){
+            continue;
+        }
+
+        size_t digits = 1;
+        for (uint64_t rest = uint64_t(whole); rest >= 10; rest /= 10){
+            ++digits;
+        }
+        if (p != 0){
+            digits = std::max(digits, p + 1) + 1; //the leading 0 and the point
+        }
+        return digits + (std::signbit(value) ? 1 : 0);
+    }
+
+    char buffer[FORMAT_SIZE];
+    return format(value, buffer);
+}
+
 
 
 
 //***************************stringCell***************************//
 
-stringCell::stringCell(const std::string& s_value) : s_value(s_value)
+stringCell::stringCell(const std::string& s_value)
 {
     /* OLD CODE
     value = s_value;
@@ -88,27 +124,41 @@ stringCell::stringCell(const std::string& s_value) : s_value(s_value)
         value.push_back(s_value[i]);
     }
     //--------------------------------------------//
+
+    try {
+        num_value = std::stod(value);
+    } catch (std::exception& e){
+        num_value = 0.0;
+    }
 }
 
 Type stringCell::getType() { return Type::STRING; }
 
 const std::string& stringCell::getValue() const { return value; }
 
-std::string stringCell::getS_Value() const { return s_value; }
+std::string stringCell::getS_Value() const { return escape(value.data(), value.size()); }
 
-double stringCell::getNum_Value()
-{
-    try {
-        return std::stod(value);
-    } catch (std::exception& e){
-        return 0.0;
-    }
-}
+double stringCell::getNum_Value() { return num_value; }
 
 void stringCell::print() const { std::cout << value; }
 
 size_t stringCell::getSpacing() { return value.size(); }
 
+std::string stringCell::escape(const char* value, size_t size)
+{
+    std::string s_value;
+    s_value.reserve(size + 2);
+    s_value.push_back('"');
+    for (size_t i=0; i<size; ++i){
+        if (value[i] == '"' || value[i] == '\\'){
+            s_value.push_back('\\');
+        }
+        s_value.push_back(value[i]);
+    }
+    s_value.push_back('"');
+    return s_value;
+}
+
 
 
 //***************************emptyCell***************************//
@@ -1,16 +1,41 @@
 #include "../headers/commands.h"
+#include "../headers/mappedFile.h"
 #include <iostream>
 
-Commands::Commands()
+
+
+namespace {
+
+//////////////////////////////////////////////////////
+///@brief Check the extension of a file. The format of a saved document is chosen by it:
+///       .sheet is the binary format (see Table::saveBinary()), .csvz and .sheetz are
+///       the text and the binary format compressed with BlockCodec.
+///
+///@param path Path leading to the file.
+///@param extension The extension, with the dot.
+///@return True if the path ends with the extension.
+//////////////////////////////////////////////////////
+bool hasExtension(const std::string& path, const std::string& extension)
+{
+    return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+}
+
+Commands::Commands() : savingDone(false)
 {
     table = nullptr;
-    dataSaved = true;
+    version = 0;
+    savedVersion = 0;
+    journal = nullptr;
 }
 
 
 Commands::~Commands()
 {
+    waitForSave();
     delete table;
+    delete journal;
 }
 
 
@@ -32,27 +57,30 @@ void Commands::NEW()
 {
     CLOSE();
     table = new Table();
-    dataSaved = true;
+    savedVersion = version;
     path.push_back('\0'); //means we have a doc but it does not have a path yet
     std::cout << "New document created successfully!\n";
 }
 
 
 
-void Commands::OPEN(const std::string& path)
+void Commands::OPEN(const std::string& path, bool lazy)
 {
     CLOSE();
-    std::ifstream file(path);
-    if (!file.is_open()){
-        throw std::runtime_error("Error loading file! You have probably chosen an unexisting file!");
-    }
+    std::unique_ptr<MappedFile> file(new MappedFile(path)); //throws if the file cannot be opened
 
     try {
-        table = new Table(file);
-        file.close();
+        table = lazy ? new Table(std::move(file)) : new Table(file->getData());
         this->path = path;
-        dataSaved = true;
+        savedVersion = version;
         std::cout << "Successfully opened " << path << std::endl;
+
+        //the edits saved in journal mode are applied on top of the document
+        size_t edits = Journal::replay(path, *table);
+        if (edits > 0){
+            journal = new Journal(path);
+            std::cout << "Applied " << edits << " edits from " << Journal::pathOf(path) << std::endl;
+        }
     } catch (const std::invalid_argument& e){
         std::cerr << e.what() << std::endl;
         CLOSE();
@@ -72,15 +100,15 @@ void Commands::SAVE()
         throw std::logic_error("ERROR: No file chosen. \nHint: Use \"SaveAs <file_name>\" to save the Document");
     }
 
-    std::ofstream file(path, std::ios::trunc);
-    if (!file.is_open()){
-        throw std::runtime_error("Error opening file!");
+    if (journal){
+        waitForSave(); //the journal is deleted when the document is written
+        journal->sync();
+        savedVersion = version;
+        std::cout << "Successfully saved to " << Journal::pathOf(path) << std::endl;
+        return;
     }
-    table->saveInFile(file);
-   
-    dataSaved = true;
-    file.close();
-    std::cout << "Successfully saved to " << path << std::endl;
+
+    startSave(path);
 }
 
 
@@ -108,16 +136,65 @@ void Commands::SAVEAS(const std::string& path)
         check.close();
     }
 
-    std::ofstream file(path, std::ios::trunc);
-    if (!file.is_open()){
-        throw std::runtime_error("Error opening file!");
+    startSave(path);
+
+    //the journal of the old path does not apply to the new one
+    if (journal){
+        delete journal;
+        journal = new Journal(path);
     }
-    table->saveInFile(file);
 
     this->path = path;
-    dataSaved = true;
-    file.close();
-    std::cout << "Successfully saved to " << path << std::endl;
+}
+
+
+
+void Commands::JOURNAL(bool on)
+{
+    if (!table){
+        throw std::invalid_argument("Error: no document is currently opened\nHint: open an existing file, or create a new document first.");
+    }
+
+    if (path.front() == '\0'){
+        throw std::logic_error("ERROR: No file chosen. \nHint: Use \"SaveAs <file_name>\" to save the Document");
+    }
+
+    if (on && !journal){
+        //the journal only records the edits made from now on
+        if (!isSaved()){
+            SAVE();
+        }
+        journal = new Journal(path);
+    }
+    else if (!on && journal){
+        //the edits which are not saved yet will be saved with the whole document
+        delete journal;
+        journal = nullptr;
+    }
+
+    std::cout << "Journal mode is " << (on ? "on" : "off") << std::endl;
+}
+
+
+
+void Commands::COMPACT()
+{
+    if (!table){
+        throw std::invalid_argument("Error: no document is currently opened\nHint: open an existing file, or create a new document first.");
+    }
+
+    if (path.front() == '\0'){
+        throw std::logic_error("ERROR: No file chosen. \nHint: Use \"SaveAs <file_name>\" to save the Document");
+    }
+
+    waitForSave();
+    write(path, *table);
+    if (journal){
+        delete journal;
+        journal = new Journal(path);
+    }
+    savedVersion = version;
+    std::cout << "Successfully compacted " << path << std::endl;
 }
 
 
@@ -128,7 +205,8 @@ void Commands::CLOSE()
         return;
     }
 
-    if (!dataSaved){
+    waitForSave();
+    if (!isSaved()){
         std::cout << "File not saved! Do you want to save it before closing? (Y/N)\n";
         char choice;
         do {
@@ -138,11 +216,14 @@ void Commands::CLOSE()
 
         if (choice == 'Y' || choice == 'y'){
             SAVE();
+            waitForSave();
         }
     }
 
     delete table;
     table = nullptr;
+    delete journal;
+    journal = nullptr;
     path.clear();
 
 }
@@ -160,18 +241,18 @@ void Commands::GET(const std::string& cellAddress)
 
     readCellAddress(cellAddress, col, row); //throws if address is not valid
 
-    Cell** found = table->getCell(col, row);
+    Cell* found = table->getCell(col, row);
     if (!found){
         std::cout << col << row << " has a value of 0\n";
         return;
     }
 
-    std::string value_of_cell = (*found)->getS_Value();
+    std::string value_of_cell = found->getS_Value();
     if (value_of_cell.size() == 0){
         std::cout << col << row << " is an empty cell" << std::endl; 
     }
     else {
-        std::cout << col << row << " has a value of " << (*table->getCell(col, row))->getS_Value() << std::endl;
+        std::cout << col << row << " has a value of " << value_of_cell << std::endl;
     }
 }
 
@@ -188,7 +269,10 @@ void Commands::EDIT(const std::string& cellAddress, std::string& newValue)
     readCellAddress(cellAddress, col, row); //throws if address is not valid
 
     table->setValue(col, row, newValue);
-    dataSaved = false;
+    if (journal){
+        journal->append(col, row, newValue);
+    }
+    ++version;
     std::cout << col << row << " successfully set to " << newValue << std::endl;
 }
 
@@ -204,23 +288,87 @@ void Commands::PRINT()
 
 
 
+void Commands::PRINT(const std::string& range)
+{
+    if (!table){
+        throw std::invalid_argument("Error: no document is currently opened\nHint: open an existing file, or create a new document first.");
+    }
+
+    size_t colon = range.find(':');
+    if (colon == std::string::npos){
+        throw std::invalid_argument("Invalid range!");
+    }
+
+    char firstCol, lastCol;
+    size_t firstRow, lastRow;
+    readCellAddress(range.substr(0, colon), firstCol, firstRow); //throws if address is not valid
+    readCellAddress(range.substr(colon + 1), lastCol, lastRow);
+
+    if (firstCol > lastCol || firstRow > lastRow){
+        throw std::invalid_argument("Invalid range!");
+    }
+    table->print(size_t(firstCol - 'A'), firstRow, size_t(lastCol - 'A'), lastRow);
+}
+
+
+
+void Commands::PRINT(size_t page)
+{
+    if (!table){
+        throw std::invalid_argument("Error: no document is currently opened\nHint: open an existing file, or create a new document first.");
+    }
+    table->printPage(page);
+}
+
+
+
 void Commands::HELP()
 {
     std::cout << "Supported commands:\n"
                  "NEW                                 Create a new table\n"
-                 "OPEN   <path>                       Open an existing table\n"
+                 "OPEN   <path> [LAZY]                Open an existing table, LAZY reads the rows when they are used\n"
                  "SAVE                                Save the current table\n"
-                 "SAVEAS <path>                       Save a table into specified file\n"
+                 "SAVEAS <path>                       Save a table into specified file, .sheet/.csvz/.sheetz for binary/compressed\n"
+                 "JOURNAL <on/off>                    Save only the edits into <path>.journal\n"
+                 "COMPACT                             Save the whole table and delete its journal\n"
                  "CLOSE                               Close the current table\n"
                  "GET    <cellAddress>                Retrieve the value of a cell\n"
                  "EDIT   <cellAddress> <newValue>     Change the value of a cell\n"
-                 "PRINT                               Print the current table\n"
+                 "PRINT  [<range>/PAGE <n>]           Print the current table, a range such as A1:F50 or 50 rows\n"
                  "HELP                                Show supported commands\n"
                  "EXIT                                Exit the application\n" << std::endl;
 }
 
 
 
+void Commands::reportSave()
+{
+    if (saving.joinable() && savingDone){
+        waitForSave();
+    }
+}
+
+
+
+void Commands::waitForSave()
+{
+    if (!saving.joinable()){
+        return;
+    }
+
+    saving.join();
+    if (savingError.empty()){
+        savedVersion = savingVersion;
+        std::cout << "Successfully saved to " << savingPath << std::endl;
+    }
+    else {
+        std::cerr << savingError << std::endl;
+        savingError.clear();
+    }
+}
+
+
+
 void Commands::EXIT()
 {
     CLOSE();
@@ -256,4 +404,59 @@ void Commands::readCellAddress(const std::string& cellAddress, char& col, size_t
     if (row == 0){
         throw std::invalid_argument("Invalid cell!");
     }
-}
\ No newline at end of file
+}
+
+
+
+bool Commands::isSaved() const
+{
+    return savedVersion == version;
+}
+
+
+
+void Commands::startSave(const std::string& path)
+{
+    waitForSave();
+
+    //copying the table is much faster than formatting it, and the copy is not changed by the next edits
+    std::unique_ptr<Table> snapshot = table->snapshot();
+    savingPath = path;
+    savingVersion = version;
+    savingDone = false;
+
+    saving = std::thread([this, snapshot = std::move(snapshot)]() {
+        try {
+            write(savingPath, *snapshot);
+        } catch (const std::exception& e){
+            savingError = e.what();
+        }
+        savingDone = true;
+    });
+    std::cout << "Saving to " << path << " in the background..." << std::endl;
+}
+
+
+
+void Commands::write(const std::string& path, Table& table)
+{
+    table.readRows(); //a lazily opened table may read from the file which is overwritten
+
+    bool binary = hasExtension(path, ".sheet") || hasExtension(path, ".sheetz");
+    bool compressed = hasExtension(path, ".csvz") || hasExtension(path, ".sheetz");
+    std::ofstream file(path, binary || compressed ? std::ios::trunc | std::ios::binary : std::ios::trunc);
+    if (!file.is_open()){
+        throw std::runtime_error("Error opening file!");
+    }
+    if (binary){
+        table.saveBinary(file, compressed);
+    }
+    else {
+        table.saveInFile(file, compressed);
+    }
+    file.close();
+    if (file.fail()){
+        throw std::runtime_error("Error writing file " + path + "!");
+    }
+    Journal::remove(path);
+}
@@ -1,128 +1,116 @@
 #include "../headers/formulaCell.h"
 #include "../headers/table.h"
 #include <iostream>
-#include <queue>
 #include <cmath>
 
 
 
-formulaCell::formulaCell(const std::string& value, Table* ptr) : value (value), result(0), table(ptr)
-{}
+formulaCell::formulaCell(const std::string& value, Table* ptr) : value (value), result(0), table(ptr), dirty(true), failed(false)
+{
+    try {
+        program = compile(value, 1); //to start after the '=' symbol
+        compiled = true;
+    } catch (const std::logic_error& e){
+        compiled = false;
+    }
+}
+
+formulaCell::formulaCell(const std::string& value, Table* ptr, std::vector<Instruction>&& program, bool compiled, double result, bool failed)
+    : value (value), result(result), table(ptr), program(std::move(program)), compiled(compiled), dirty(false), failed(failed)
+{
+    result_string = failed ? "#ERROR" : doubleCell::format(result);
+}
+
+formulaCell::formulaCell(const formulaCell& other, Table* ptr) : formulaCell(other)
+{
+    table = ptr;
+}
 
 Type formulaCell::getType() { return Type::FORMULA; }
 
 std::string formulaCell::getS_Value() const { return value; }
 
-const std::vector<Cell**>& formulaCell::getDependingOn() { return dependingOn; }
+const std::string& formulaCell::getValue() const { return value; }
+
+const std::vector<Instruction>& formulaCell::getProgram() const { return program; }
 
-//print() is always called after calling getSpacing()
-//that means result_string is re-calculated every time print() is called
+//result_string is made only by calculating, printing just reads it
 void formulaCell::print() const 
 { 
     std::cout << result_string; 
 }
 
 size_t formulaCell::getSpacing() 
+{
+    calculateIfDirty();
+    return result_string.size();
+}
+
+size_t formulaCell::getWidth() const { return result_string.size(); }
+
+const std::string& formulaCell::getResult_String() const { return result_string; }
+
+void formulaCell::markDirty() { dirty = true; }
+
+bool formulaCell::isDirty() const { return dirty; }
+
+bool formulaCell::isFailed() const { return failed; }
+
+bool formulaCell::isCompiled() const { return compiled; }
+
+void formulaCell::refresh()
 {
     try {
         result = calculate();
+        failed = false;
     } catch (const std::logic_error& e){
-        result_string = "#ERROR";
-        return 6; //#ERROR
-    }
-    
-    result_string = std::to_string(result);
-    //delete unnecessary zeros
-    while (result_string.back() == '0'){
-        result_string.pop_back();
+        failed = true;
     }
+    dirty = false;
 
-    if (result_string.back() == '.'){
-        result_string.pop_back();
+    if (failed){
+        result_string = "#ERROR";
+        return;
     }
-    return result_string.size();
+    
+    result_string = doubleCell::format(result);
 }
 
-double formulaCell::getNum_Value() 
+void formulaCell::markFailed()
 {
-    return calculate();
+    failed = true;
+    dirty = false;
+    result_string = "#ERROR";
 }
 
-
-void formulaCell::fill_dependingOn()
+void formulaCell::calculateIfDirty()
 {
-    dependingOn.clear();
-    
-    for (size_t i=1; i<value.size(); ++i){ //to start after the '=' symbol
-        if (value[i] >= 'A' && value[i] <= 'Z'){
-            char col = value[i];
-            ++i;
-            std::string number;
-            while (i<value.size() && !isOperator(value[i])){
-                number.push_back(value[i]);
-                ++i;
-            }
-            --i;
-            size_t row = std::stoi(number);
-            dependingOn.push_back(table->getCell(col, row));
-        }
+    if (dirty && table){
+        table->recalculate(); //calculates this formula too if it is part of the table
     }
-    
-    //removing nullptrs from dependingOn vector
-    for (size_t i=0; i<dependingOn.size(); ++i){
-        if (dependingOn[i] == nullptr){
-            dependingOn.erase(dependingOn.begin() + i);
-            --i;
-        }
+
+    if (dirty){
+        refresh();
     }
-    
 }
 
-
-double formulaCell::calculate()
+double formulaCell::getNum_Value() 
 {
-    fill_dependingOn();
-    std::vector <Cell*> forbiddenCells;
-    forbiddenCells.push_back(this);
-    checkForRecursion(this, forbiddenCells); //throws if there is recursion
-    
-    std::string calc_exp = getCalculationExpression(); //expression only with operands and numbers
-    return shuntingYard(calc_exp);
-}
+    calculateIfDirty();
 
+    if (failed){
+        throw std::logic_error("The formula cannot be calculated");
+    }
+    return result;
+}
 
 
-std::string formulaCell::getCalculationExpression()
+double formulaCell::calculate()
 {
-    std::string calc_exp;
-    for (size_t i=1; i<value.size(); ++i){ //start from 1 to avoid = symbol
-
-        if (isDigit(value[i]) || isOperator(value[i]) || value[i] == '.'){
-            calc_exp.push_back(value[i]);
-        }
-        else {
-            std::string cellAddress;
-            while (i<value.size() && !isOperator(value[i])){
-                cellAddress.push_back(value[i]);
-                ++i;
-            }
-            --i;
-
-            char col = cellAddress[0]; //get the column
-            cellAddress.erase(0,1);
-            Cell** found = table->getCell(col, std::stoi(cellAddress));
-      
-            if (!found){
-                calc_exp += '0';
-            }
-            else {
-                std::string num_value = std::to_string((*found)->getNum_Value());
-                calc_exp += num_value;
-            }
-            
-        }
+    if (!compiled){
+        throw std::invalid_argument("Invalid formula " + value);
     }
-    return calc_exp;
+    return execute(program, table);
 }
 
 
@@ -152,102 +140,145 @@ bool formulaCell::isBiggerOperator(char c, char top)
 
 double formulaCell::shuntingYard(const std::string& exp)
 {
-    std::queue <double> numbers;
+    return execute(compile(exp), nullptr);
+}
+
+
+
+std::vector<Instruction> formulaCell::compile(const std::string& exp, size_t from)
+{
+    std::vector <Instruction> output;
     std::vector <char> operators;
-    std::queue <char> queue;
-
-    bool partOfNumber = false; //true if the last read char was an operator
-    for (size_t i=0; i<exp.size(); ++i){
-        if (isDigit(exp[i]) || partOfNumber){
-            std::string number;
-            number.push_back(exp[i]);
-            ++i;
-            while (i<exp.size() && !isOperator(exp[i])){
-                number.push_back(exp[i]);
-                ++i;
+
+    bool expectOperand = true; //true if the last read thing was an operator
+    bool negative = false;     //true if the next operand has '-' sign
+    for (size_t i=from; i<exp.size(); ++i){
+
+        if (expectOperand && (exp[i] == '+' || exp[i] == '-')){
+            if (exp[i] == '-'){
+                negative = !negative;
             }
-            --i;
-            numbers.push(stod(number));
-            queue.push('#'); //means there is a number on this position
-            partOfNumber = false;
+            continue;
         }
 
-        else { //exp[i] is operator
+        if (expectOperand){
+            Instruction operand{};
+
+            if (isDigit(exp[i]) || exp[i] == '.'){
+                size_t start = i;
+                while (i<exp.size() && (isDigit(exp[i]) || exp[i] == '.')){
+                    ++i;
+                }
+                operand.kind = Instruction::Kind::NUMBER;
+                operand.number = std::stod(exp.substr(start, i - start));
+            }
+            else if (exp[i] >= 'A' && exp[i] <= 'Z'){
+                operand.kind = Instruction::Kind::REFERENCE;
+                operand.col = exp[i];
+                size_t start = ++i;
+                while (i<exp.size() && !isOperator(exp[i])){
+                    ++i;
+                }
+                operand.row = std::stoi(exp.substr(start, i - start));
+            }
+            else {
+                throw std::invalid_argument("Unexpected symbol in expression");
+            }
+            --i;
 
-            if (isOperator(exp[i-1])){
-                partOfNumber = true;
-                --i;
-                continue;
+            output.push_back(operand);
+            if (negative){
+                Instruction negate{};
+                negate.kind = Instruction::Kind::NEGATE;
+                output.push_back(negate);
+            }
+            negative = false;
+            expectOperand = false;
+        }
+
+        else { //exp[i] must be operator
+            if (!isOperator(exp[i])){
+                throw std::invalid_argument("Unexpected symbol in expression");
             }
 
             while ( operators.size() != 0 && !isBiggerOperator(exp[i], operators.back()) ){
-                char op = operators.back();
-                queue.push(op);
+                Instruction op{};
+                op.kind = Instruction::Kind::OPERATOR;
+                op.op = operators.back();
+                output.push_back(op);
                 operators.pop_back();
             }
             operators.push_back(exp[i]);
-        
+            expectOperand = true;
         }
     }
 
-    //adding the remaining operators to the queue
-    while (!operators.empty()){
-        queue.push(operators.back());
-        operators.pop_back();
+    if (expectOperand){
+        throw std::invalid_argument("Expression ends with an operator");
     }
 
-    std::vector <double> number_stack;
-
-    while (!queue.empty()){
-        char cur = queue.front();
-        if ( cur == '#' ){
-            number_stack.push_back(numbers.front());
-            numbers.pop();
-        }
-        else { //cur is operator
-            double num2 = number_stack.back();
-            number_stack.pop_back();
-            double num1 = number_stack.back();
-            number_stack.pop_back();
-
-            double res; //the result
-            switch (cur){
-                case '+': res = num1 + num2; break;
-                case '-': res = num1 - num2; break;
-                case '*': res = num1 * num2; break;
-                case '/': if ( abs(num2-0) < 0.00001 ) throw std::invalid_argument("Division by 0 is forbidden"); 
-                          res = num1 / num2; break;
-                case '^': res = pow (num1, num2); break;
-                default: std::runtime_error("Unexpected error!");
-            }
-            number_stack.push_back(res);
-        }
-        queue.pop();
+    //adding the remaining operators
+    while (!operators.empty()){
+        Instruction op{};
+        op.kind = Instruction::Kind::OPERATOR;
+        op.op = operators.back();
+        output.push_back(op);
+        operators.pop_back();
     }
 
-    return number_stack.back();
+    return output;
 }
 
 
-void formulaCell::checkForRecursion(formulaCell* cell, std::vector<Cell*>& forbiddenCells)
+
+double formulaCell::execute(const std::vector<Instruction>& program, Table* table)
 {
-    //to_check consist of the cells which the current cell depends on
-    std::vector <Cell**> to_check = cell->getDependingOn();
+    //the memory of the stack is reused by all calculations,
+    //the ones started while calculating this formula work above base
+    static thread_local std::vector <double> number_stack;
+    size_t base = number_stack.size();
 
-    for (size_t i=0; i<to_check.size(); ++i){
-        for (size_t j=0; j<forbiddenCells.size(); ++j){
-            if (*to_check[i] == forbiddenCells[j]){
-                throw std::logic_error("Recursion!");
+    try {
+        for (size_t i=0; i<program.size(); ++i){
+            const Instruction& cur = program[i];
+
+            if (cur.kind == Instruction::Kind::NUMBER){
+                number_stack.push_back(cur.number);
             }
-        }
-    }
 
-    
-    for (size_t i=0; i<to_check.size(); ++i){
-        if ( (*to_check[i])->getType() == Type::FORMULA ){
-            forbiddenCells.push_back(cell);
-            checkForRecursion(dynamic_cast<formulaCell*>(*to_check[i]), forbiddenCells);
-            forbiddenCells.pop_back();
+            else if (cur.kind == Instruction::Kind::REFERENCE){
+                number_stack.push_back(table ? table->getNum_Value(cur.col - 'A', cur.row) : 0.0);
+            }
+
+            else if (cur.kind == Instruction::Kind::NEGATE){
+                number_stack.back() = -number_stack.back();
+            }
+
+            else { //cur is operator
+                double num2 = number_stack.back();
+                number_stack.pop_back();
+                double num1 = number_stack.back();
+                number_stack.pop_back();
+
+                double res; //the result
+                switch (cur.op){
+                    case '+': res = num1 + num2; break;
+                    case '-': res = num1 - num2; break;
+                    case '*': res = num1 * num2; break;
+                    case '/': if ( std::fabs(num2-0) < 0.00001 ) throw std::invalid_argument("Division by 0 is forbidden"); 
+                              res = num1 / num2; break;
+                    case '^': res = pow (num1, num2); break;
+                    default: throw std::runtime_error("Unexpected error!");
+                }
+                number_stack.push_back(res);
+            }
         }
+    } catch (...){
+        number_stack.resize(base);
+        throw;
     }
-}
\ No newline at end of file
+
+    double res = number_stack.back();
+    number_stack.resize(base);
+    return res;
+}
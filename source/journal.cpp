@@ -0,0 +1,147 @@
+#include "../headers/journal.h"
+#include "../headers/mappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JOURNAL_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+
+namespace {
+
+//////////////////////////////////////////////////////
+///@brief The first bytes of a log file.
+///
+//////////////////////////////////////////////////////
+const char JOURNAL_MAGIC[8] = {'S', 'H', 'E', 'E', 'T', 'L', 'O', 'G'};
+
+//////////////////////////////////////////////////////
+///@brief Size of the fixed part of a record: column (1 byte), row (8 bytes) and size of the value (4 bytes).
+///       The value follows.
+//////////////////////////////////////////////////////
+const size_t RECORD_HEADER = 13;
+
+}
+
+
+
+Journal::Journal(const std::string& documentPath) : path(pathOf(documentPath))
+{}
+
+
+
+void Journal::append(char col, size_t row, const std::string& newValue)
+{
+    uint64_t row64 = row;
+    uint32_t size = uint32_t(newValue.size());
+    pending.push_back(col);
+    pending.append(reinterpret_cast<const char*>(&row64), sizeof(row64));
+    pending.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    pending.append(newValue);
+}
+
+
+
+void Journal::sync()
+{
+#ifdef JOURNAL_POSIX
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0){
+        throw std::runtime_error("Error opening file!");
+    }
+
+    std::string data;
+    if (lseek(fd, 0, SEEK_END) == 0){
+        data.assign(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    }
+    data += pending;
+
+    size_t written = 0;
+    while (written < data.size()){
+        ssize_t result = write(fd, data.data() + written, data.size() - written);
+        if (result < 0){
+            close(fd);
+            throw std::runtime_error("Error writing the journal!");
+        }
+        written += size_t(result);
+    }
+
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    if (!synced){
+        throw std::runtime_error("Error writing the journal!");
+    }
+#else
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    if (!file.is_open()){
+        throw std::runtime_error("Error opening file!");
+    }
+    if (file.tellp() == 0){
+        file.write(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    }
+    file.write(pending.data(), pending.size());
+    file.flush();
+    if (!file){
+        throw std::runtime_error("Error writing the journal!");
+    }
+#endif
+
+    pending.clear();
+}
+
+
+
+std::string Journal::pathOf(const std::string& documentPath)
+{
+    return documentPath + ".journal";
+}
+
+
+
+size_t Journal::replay(const std::string& documentPath, Table& table)
+{
+    std::ifstream check(pathOf(documentPath));
+    if (!check.is_open()){
+        return 0;
+    }
+    check.close();
+
+    MappedFile file(pathOf(documentPath));
+    std::string_view data = file.getData();
+    if (data.size() < sizeof(JOURNAL_MAGIC) || data.substr(0, sizeof(JOURNAL_MAGIC)) != std::string_view(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC))){
+        throw std::invalid_argument("Error: " + pathOf(documentPath) + " is not a journal");
+    }
+
+    size_t read = sizeof(JOURNAL_MAGIC);
+    size_t count = 0;
+    while (data.size() - read >= RECORD_HEADER){
+        char col = data[read];
+        uint64_t row;
+        uint32_t size;
+        std::memcpy(&row, data.data() + read + 1, sizeof(row));
+        std::memcpy(&size, data.data() + read + 9, sizeof(size));
+        if (data.size() - read - RECORD_HEADER < size || col < 'A' || col > 'Z' || row == 0){
+            break;
+        }
+
+        std::string newValue(data.substr(read + RECORD_HEADER, size));
+        table.setValue(col, size_t(row), newValue);
+        read += RECORD_HEADER + size;
+        ++count;
+    }
+
+    return count;
+}
+
+
+
+void Journal::remove(const std::string& documentPath)
+{
+    std::remove(pathOf(documentPath).c_str());
+}
@@ -0,0 +1,70 @@
+#include "../headers/mappedFile.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::MappedFile(const std::string& path) : data(nullptr), size(0), mapped(false)
+{
+#ifdef MAPPED_FILE_POSIX
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        throw std::runtime_error("Error loading file! You have probably chosen an unexisting file!");
+    }
+
+    struct stat info;
+    bool regular = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    if (regular && info.st_size > 0){
+        void* mapping = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED){
+            madvise(mapping, size_t(info.st_size), MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+            size = size_t(info.st_size);
+            mapped = true;
+        }
+    }
+    close(fd);
+
+    //an empty file cannot be mapped but there is nothing to read
+    if (mapped || (regular && info.st_size == 0)){
+        return;
+    }
+#endif
+
+    //reading the whole file if it cannot be mapped
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()){
+        throw std::runtime_error("Error loading file! You have probably chosen an unexisting file!");
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    buffer = contents.str();
+    data = buffer.data();
+    size = buffer.size();
+}
+
+
+
+MappedFile::~MappedFile()
+{
+#ifdef MAPPED_FILE_POSIX
+    if (mapped){
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+
+
+std::string_view MappedFile::getData() const
+{
+    return std::string_view(data, size);
+}
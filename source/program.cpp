@@ -10,6 +10,7 @@ void Program::Go()
 {
     while (!wantToExit){
         std::string command;
+        commands.reportSave(); //a save may have finished while the last command was running
         std::cout << ">";
         getline(std::cin, command);
         try {
@@ -104,7 +105,8 @@ void Program::executeCommand(const std::string& command)
 
     else if (cmdName == "open"){
 
-        if (firstArg.size() == 0 || secondArg.size() != 0){
+        toLowerCase(secondArg);
+        if (firstArg.size() == 0 || (secondArg.size() != 0 && secondArg != "lazy")){
             throw std::invalid_argument("Invalid command!");
         }
 
@@ -114,7 +116,7 @@ void Program::executeCommand(const std::string& command)
             firstArg.pop_back();
         }
 
-        commands.OPEN(firstArg);
+        commands.OPEN(firstArg, secondArg == "lazy");
     }
 
 
@@ -170,6 +172,29 @@ void Program::executeCommand(const std::string& command)
 
 
 
+    else if (cmdName == "journal"){
+
+        toLowerCase(firstArg);
+        if ((firstArg != "on" && firstArg != "off") || secondArg.size() != 0){
+            throw std::invalid_argument("Invalid command!");
+        }
+
+        commands.JOURNAL(firstArg == "on");
+    }
+
+
+
+    else if (cmdName == "compact"){
+
+        if (firstArg.size() != 0){
+            throw std::invalid_argument("Invalid command!");
+        }
+
+        commands.COMPACT();
+    }
+
+
+
     else if (cmdName == "get"){
 
         if (firstArg.size() == 0 || secondArg.size() != 0){
@@ -198,10 +223,22 @@ void Program::executeCommand(const std::string& command)
 
     else if (cmdName == "print"){
         
-        if (firstArg.size() != 0){
-            throw std::invalid_argument("Invalid command!");
+        toLowerCase(firstArg);
+        if (firstArg.size() == 0){
+            commands.PRINT();
+        }
+        else if (firstArg == "page"){
+            if (secondArg.size() == 0 || secondArg.find_first_not_of("0123456789") != std::string::npos){
+                throw std::invalid_argument("Invalid command!");
+            }
+            commands.PRINT(size_t(std::stoull(secondArg)));
+        }
+        else {
+            if (secondArg.size() != 0){
+                throw std::invalid_argument("Invalid command!");
+            }
+            commands.PRINT(firstArg);
         }
-        commands.PRINT();
     }
 
 
@@ -0,0 +1,101 @@
+#include "../headers/scanner.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+//////////////////////////////////////////////////////
+///@brief Compare 64 bytes with a symbol.
+///
+///@return Bit i is set if byte i is the symbol.
+//////////////////////////////////////////////////////
+inline uint64_t compare(const char* data, char symbol)
+{
+#if defined(__AVX2__)
+    __m256i s = _mm256_set1_epi8(symbol);
+    uint64_t low = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), s)));
+    uint64_t high = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32)), s)));
+    return low | (high << 32);
+#elif defined(__SSE2__)
+    __m128i s = _mm_set1_epi8(symbol);
+    uint64_t result = 0;
+    for (size_t i=0; i<4; ++i){
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i));
+        result |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, s)))) << (16 * i);
+    }
+    return result;
+#else
+    uint64_t result = 0;
+    for (size_t i=0; i<64; ++i){
+        result |= uint64_t(data[i] == symbol) << i;
+    }
+    return result;
+#endif
+}
+
+}
+
+
+
+Scanner::Scanner(std::string_view data, char symbol) : data(data), symbol(symbol), block(0), mask(0)
+{
+    if (!data.empty()){
+        mask = scan(data.data(), data.size() < 64 ? data.size() : 64, symbol);
+    }
+}
+
+
+
+size_t Scanner::next()
+{
+    while (mask == 0){
+        block += 64;
+        if (block >= data.size()){
+            block = data.size();
+            return data.size();
+        }
+        size_t size = data.size() - block;
+        mask = scan(data.data() + block, size < 64 ? size : 64, symbol);
+    }
+
+    size_t position = block + lowestBit(mask);
+    mask &= mask - 1;
+    return position;
+}
+
+
+
+size_t Scanner::lowestBit(uint64_t mask)
+{
+#if defined(__GNUC__)
+    return size_t(__builtin_ctzll(mask));
+#else
+    size_t i = 0;
+    while (!(mask & 1)){
+        mask >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+
+
+uint64_t Scanner::scan(const char* data, size_t size, char symbol)
+{
+    //the last block of the data is copied, so it can be loaded as a whole
+    char copy[64];
+    if (size < 64){
+        std::memset(copy, 0, sizeof(copy));
+        std::memcpy(copy, data, size);
+        data = copy;
+    }
+
+    return compare(data, symbol);
+}
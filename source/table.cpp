@@ -1,301 +1,1440 @@
 #include "../headers/table.h"
+#include "../headers/scanner.h"
+#include "../headers/blockCodec.h"
 #include <iostream>
+#include <algorithm>
+#include <unordered_set>
+#include <bitset>
+#include <new>
+#include <charconv>
+#include <cctype>
+#include <thread>
+#include <atomic>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TABLE_POSIX
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+
+
+namespace {
+
+//////////////////////////////////////////////////////
+///@brief Call f for every line of data. Like reading with getline: n new lines mean n+1 lines.
+///
+//////////////////////////////////////////////////////
+template <typename F>
+void forEachLine(std::string_view data, F f)
+{
+    Scanner newLines(data, '\n');
+    size_t begin = 0;
+    while (true){
+        size_t end = newLines.next();
+        if (end == data.size()){
+            f(data.substr(begin));
+            return;
+        }
+        f(data.substr(begin, end - begin));
+        begin = end + 1;
+    }
+}
+
+
+
+//////////////////////////////////////////////////////
+///@brief The first bytes of a file in the binary format and the version of the format.
+///
+//////////////////////////////////////////////////////
+const char BINARY_MAGIC[8] = {'S', 'H', 'E', 'E', 'T', 'B', 'I', 'N'};
+const uint32_t BINARY_VERSION = 1;
+
+
+
+//////////////////////////////////////////////////////
+///@brief Writes to a file through one big buffer. put() writes values in the byte order of the machine.
+///       In a compressed file every full buffer is one block (see BlockCodec).
+//////////////////////////////////////////////////////
+class FileWriter {
+
+private:
+
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    std::ofstream& file;
+    std::string buffer;
+    bool compressed;
+    std::string block;
+
+public:
+
+    FileWriter(std::ofstream& file, bool compressed = false) : file(file), compressed(compressed)
+    {
+        buffer.reserve(BUFFER_SIZE + 512);
+        if (compressed){
+            BlockCodec::writeHeader(block);
+            file.write(block.data(), block.size());
+        }
+    }
+
+    ~FileWriter()
+    {
+        flush();
+        if (compressed){
+            block.clear();
+            BlockCodec::writeEnd(block);
+            file.write(block.data(), block.size());
+        }
+    }
+
+    template <typename T>
+    void put(T value)
+    {
+        putBytes(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putBytes(const char* data, size_t size)
+    {
+        buffer.append(data, size);
+        if (buffer.size() >= BUFFER_SIZE){
+            flush();
+        }
+    }
+
+    void putChar(char c)
+    {
+        buffer.push_back(c);
+        if (buffer.size() >= BUFFER_SIZE){
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!compressed){
+            file.write(buffer.data(), buffer.size());
+        }
+        else {
+            //a very long string or formula fills the buffer over the biggest block, so it is split
+            for (size_t from=0; from<buffer.size(); from+=BlockCodec::MAX_BLOCK){
+                block.clear();
+                BlockCodec::writeBlock(buffer.data() + from, std::min(size_t(BlockCodec::MAX_BLOCK), buffer.size() - from), block);
+                file.write(block.data(), block.size());
+            }
+        }
+        buffer.clear();
+    }
+};
+
+
+
+//////////////////////////////////////////////////////
+///@brief Reads values written by FileWriter::put(), checking the end of the data.
+///
+//////////////////////////////////////////////////////
+class BinaryReader {
+
+private:
+
+    std::string_view data;
+    size_t read;
+
+public:
+
+    BinaryReader(std::string_view data) : data(data), read(0) {}
+
+    template <typename T>
+    T get()
+    {
+        T value;
+        std::memcpy(&value, getBytes(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::string_view getBytes(size_t size)
+    {
+        if (size > data.size() - read){
+            throw std::invalid_argument("Error: the file is damaged");
+        }
+        read += size;
+        return data.substr(read - size, size);
+    }
+};
+
+}
+
+
 
 Table::Table()
 {
+    rowCount = 0;
     longestRow = 0;
+    recalculating = false;
 }
 
 
 Table::Table(std::ifstream& file)
 {
+    rowCount = 0;
     longestRow = 0;
-    readFromFile(file);
+    recalculating = false;
+    try {
+        readFromFile(file);
+    } catch (...){
+        deleteFormulas(); //the destructor is not called
+        throw;
+    }
 }
 
 
-Table::~Table()
+Table::Table(std::string_view data)
+{
+    rowCount = 0;
+    longestRow = 0;
+    recalculating = false;
+    try {
+        readData(data);
+    } catch (...){
+        deleteFormulas(); //the destructor is not called
+        throw;
+    }
+}
+
+
+Table::Table(std::unique_ptr<MappedFile> file)
 {
-    for (size_t i=0; i<cells.size(); ++i){
-        for (size_t j=0; j<cells[i].size(); ++j){
-            delete cells[i][j];
+    rowCount = 0;
+    longestRow = 0;
+    recalculating = false;
+
+    std::string_view data = file->getData();
+    if (isBinary(data) || BlockCodec::isCompressed(data)){
+        try {
+            readData(data);
+        } catch (...){
+            deleteFormulas(); //the destructor is not called
+            throw;
+        }
+        return;
+    }
+
+    //only the first line of every block is remembered, like reading with getline: n new lines mean n+1 rows
+    Scanner newLines(data, '\n');
+    blockOffsets.push_back(0);
+    rowCount = 1;
+    for (size_t end = newLines.next(); end != data.size(); end = newLines.next()){
+        if (rowCount % BLOCK_ROWS == 0){
+            blockOffsets.push_back(end + 1);
         }
-        cells[i].clear();
+        ++rowCount;
     }
-    cells.clear();
+    blockRead.assign(blockOffsets.size(), false);
+    source = std::move(file);
+}
+
+
+Table::~Table()
+{
+    deleteFormulas();
+}
+
+
+
+void Table::deleteFormulas()
+{
+    //everything else is freed by the arena
+    for (auto it = formulas.begin(); it != formulas.end(); ++it){
+        delete *it;
+    }
+    formulas.clear();
 }
 
 
 
 void Table::align()
 {
-    spacing.clear();
+    readRows();
+    recalculate();
+    spacing.assign(longestRow, 0);
+    for (size_t col=0; col<longestRow; ++col){
+        spacing[col] = columnWidths[col].max();
+    }
+}
+
+
+
+void Table::print(int fd)
+{
+    if (rowCount == 0){
+        throw std::logic_error("The document is empty");
+    }
 
-    for (size_t i=0; i<cells.size(); ++i){
-        while (cells[i].size() < longestRow){
-            Cell* fill = new emptyCell;
-            cells[i].push_back(fill);
-        }
+    align();
+    printRange(0, 1, rowCount, spacing, fd);
+}
+
+
+
+void Table::print(size_t firstColumn, size_t firstRow, size_t lastColumn, size_t lastRow, int fd)
+{
+    if (lastRow > rowCount){
+        lastRow = rowCount;
     }
 
-    //going through columns
-    for (size_t j=0; j<longestRow; ++j){
-        
-        unsigned columnLongest = 0;
-        for (size_t i=0; i<cells.size(); ++i){
-            if (cells[i][j]->getSpacing() > columnLongest){
-                columnLongest = cells[i][j]->getSpacing();
+    //the rows are read first, so the number of columns of a lazily read table is known
+    for (size_t i=firstRow; i<=lastRow; ++i){
+        findRow(i);
+    }
+
+    if (lastColumn >= longestRow){
+        lastColumn = longestRow - 1;
+    }
+    if (firstRow > lastRow || longestRow == 0 || firstColumn > lastColumn){
+        throw std::logic_error("The range is out of the table");
+    }
+
+    std::vector <size_t> roots;
+    for (size_t i=firstRow; i<=lastRow; ++i){
+        for (size_t j=firstColumn; j<=lastColumn; ++j){
+            const CellValue* value = find(j, i);
+            if (value && value->type == Type::FORMULA && value->formula->isDirty()){
+                roots.push_back(address(j, i));
             }
         }
-        spacing.push_back(columnLongest);
+    }
 
+    recalculate(roots);
+
+    std::vector <unsigned> widths(lastColumn - firstColumn + 1, 0);
+    for (size_t i=firstRow; i<=lastRow; ++i){
+        for (size_t j=firstColumn; j<=lastColumn; ++j){
+            const CellValue* value = find(j, i);
+            if (value){
+                widths[j - firstColumn] = std::max(widths[j - firstColumn], unsigned(widthOf(*value)));
+            }
+        }
     }
-    
+
+    printRange(firstColumn, firstRow, lastRow, widths, fd);
 }
 
 
 
-void Table::print()
+void Table::printPage(size_t page, int fd)
 {
-    if (cells.size() == 0){
-        throw std::logic_error("The document is empty");
+    if (page == 0){
+        throw std::invalid_argument("Invalid page!");
+    }
+    if (page - 1 > rowCount / PAGE_ROWS){
+        throw std::logic_error("The range is out of the table");
     }
+    size_t firstRow = (page - 1) * PAGE_ROWS + 1;
+    print(0, firstRow, MAX_COLUMNS - 1, firstRow + PAGE_ROWS - 1, fd);
+}
+
 
-    align();
 
+void Table::printRange(size_t firstColumn, size_t firstRow, size_t lastRow, const std::vector<unsigned>& widths, int fd)
+{
     //gets the spacing required for the longest (biggest) row number 
-    size_t rowNumsSpacing = std::to_string(cells.size()).size();
+    char number[doubleCell::FORMAT_SIZE];
+    size_t rowNumsSpacing = size_t(std::to_chars(number, number + sizeof(number), lastRow).ptr - number);
+
+    rendered.clear();
+    rendered.reserve(RENDER_SIZE);
+    rendered.append(rowNumsSpacing + 1, ' ');
+    rendered += " | ";
+
+    for (size_t i=0; i<widths.size(); ++i){
+        rendered += char ('A' + firstColumn + i);
+        rendered.append(widths[i] ? widths[i] - 1 : 0, ' ');
+        rendered += " | ";
+    }
+    rendered += '\n';
     
-    std::cout << " ";
-    for (size_t i=0; i<rowNumsSpacing; ++i){
-        std::cout << " ";
+    CellValue empty;
+    for (size_t i=firstRow; i<=lastRow; ++i){
+        
+        Row* row = findRow(i);
+        size_t length = size_t(std::to_chars(number, number + sizeof(number), i).ptr - number);
+        rendered.append(rowNumsSpacing - length + 1, ' ');
+        rendered.append(number, length);
+        rendered += " | ";
+
+        for (size_t j=0; j<widths.size(); ++j){
+
+            const CellValue* found = row ? cellOf(*row, firstColumn + j) : nullptr;
+            const CellValue& cell = found ? *found : empty;
+            rendered.append(widths[j] ? widths[j] - widthOf(cell) : 1, ' ');
+            print(cell, rendered);
+            rendered += " | ";
+        }
+        rendered += '\n';
+
+        if (rendered.size() >= RENDER_SIZE){
+            writeRendered(fd);
+        }
     }
-    std::cout << " | ";
+    writeRendered(fd);
+
+    if (fd < 0){
+        std::cout.flush();
+    }
+}
 
-    for (size_t i=0; i<longestRow; ++i){
-        std::cout << char ('A' + i);
 
-        size_t emptySpacing = spacing[i] ? spacing[i] - 1 : 0;
 
-        for (size_t i=0; i<emptySpacing; ++i)
-                std::cout << " "; 
-        std::cout << " | ";
+void Table::writeRendered(int fd)
+{
+    if (fd < 0){
+        std::cout.write(rendered.data(), rendered.size());
+        rendered.clear();
+        return;
     }
-    std::cout << "\n";
-    
-    for (size_t i=0; i<cells.size(); ++i){
-        
-        std::cout << " ";
 
-        for (size_t k=0; k<rowNumsSpacing - std::to_string(i+1).size(); ++k){
-            std::cout << " ";
+#ifdef TABLE_POSIX
+    size_t written = 0;
+    while (written < rendered.size()){
+        ssize_t result = write(fd, rendered.data() + written, rendered.size() - written);
+        if (result < 0 && errno == EINTR){
+            continue;
         }
+        if (result < 0){
+            rendered.clear();
+            throw std::runtime_error("Error writing the table!");
+        }
+        written += size_t(result);
+    }
+    rendered.clear();
+#else
+    rendered.clear();
+    throw std::runtime_error("Printing to a file descriptor is not supported!");
+#endif
+}
 
-        std::cout << i + 1 << " | ";
+
+
+void Table::addRow (std::string_view row)
+{
+    parseRow(row, rowCount + 1, parsedRow);
+    appendRow(parsedRow.values.data(), parsedRow.valueColumns.data(), uint32_t(parsedRow.values.size()), parsedRow.columns, parsedRow.texts.data());
+}
+
+
+
+void Table::parseRow (std::string_view row, size_t rowNum, ParsedRow& parsed) const
+{
+    std::vector <CellValue>& values = parsed.values;
+    size_t columns = 0;
+    size_t read = 0;
+    values.clear();
+    parsed.valueColumns.clear();
+    parsed.texts.clear();
+    Scanner delimiters(row, ',');
     
-        for (size_t j=0; j<cells[i].size(); ++j){
+    try {
+        for (; read<row.size(); ++read){
+            
+            while (read<row.size() && row[read] == ' ') ++read;
+
+            //spaces are never skipped past a delimiter, so the next one ends the value
+            size_t begin = read;
+            read = delimiters.next();
+
+            size_t end = read;
+            while (end > begin && row[end-1] == ' ') --end;
+
+            std::string_view value = row.substr(begin, end - begin);
+
+            //only formulas are changed while checked, the rest is checked and converted in place
+            std::string formula;
+            CellValue number;
+            int type;
+            if (!value.empty() && value[0] == '='){
+                formula = value;
+                type = whatIsThis(formula);
+            }
+            else {
+                type = parseValue(value, number);
+            }
+
+            //Error cell
+            if (type == 0){
+                size_t ErrorRow = rowNum;
+                size_t ErrorCol = columns + 1;
+                std::string errMes("Error: row "); //Error Message
+                errMes += std::to_string(ErrorRow) + ", col " + std::to_string(ErrorCol) + ", " + std::string(value) + " is unknown data type"; 
+                throw std::invalid_argument(errMes);
+            }
 
-            size_t emptySpacing = spacing[j] ? spacing[j] - cells[i][j]->getSpacing() : 1;
-        
-            for (size_t i=0; i<emptySpacing; ++i)
-                std::cout << " ";
             
-            cells[i][j]->print();
-            std::cout << " | ";
+            //string
+            else if (type == 1){
+                //added to the string pool together with the row
+                values.push_back(CellValue::ofString(uint32_t(parsed.texts.size())));
+                parsed.texts.push_back(value);
+            }
+
+            //integer or double
+            else if (type == 2 || type == 3){
+                if (number.type == Type::EMPTY){
+                    throw std::invalid_argument("Number too Big!");
+                }
+                values.push_back(number);
+            }
+
+            //formula
+            else if (type == 5){
+                values.push_back(CellValue(new formulaCell(formula, const_cast<Table*>(this))));
+            }
+
+            //empty cells (type == 4) are not stored
+            if (type != 4){
+                parsed.valueColumns.push_back(uint32_t(columns));
+            }
+            ++columns;
+
+            if (columns >= MAX_COLUMNS && read + 1 < row.size()){
+                throw std::invalid_argument("Error: row " + std::to_string(rowNum) + " has more than " + std::to_string(MAX_COLUMNS) + " columns");
+            }
+        }
+    } catch (...){
+        //the formulas are not part of the table yet
+        for (size_t j=0; j<values.size(); ++j){
+            if (values[j].type == Type::FORMULA){
+                delete values[j].formula;
+            }
+        }
+        throw;
+    }
+
+    parsed.columns = columns;
+}
+
+
+
+void Table::appendRow (const CellValue* values, const uint32_t* valueColumns, uint32_t count, size_t columns, const std::string_view* texts)
+{
+    placeRow(rowCount + 1, values, valueColumns, count, columns, texts, nullptr);
+}
+
+
+
+void Table::placeRow (size_t rowNum, const CellValue* values, const uint32_t* valueColumns, uint32_t count, size_t columns, const std::string_view* texts, const uint32_t* widths)
+{
+    Row newRow;
+    newRow.capacity = count;
+
+    if (columns > longestRow){
+        longestRow = columns;
+        columnWidths.resize(longestRow);
+    }
+
+    if (rowNum > rowCount){
+        rowCount = rowNum;
+    }
+    if (newRow.capacity == 0){
+        return;
+    }
+
+    //the values of a row are next to each other in the arena
+    newRow.values = arena.allocateArray<CellValue>(count);
+    for (size_t j=0; j<count; ++j){
+        if (values[j].type == Type::STRING){
+            newRow.values[j] = addString(texts[values[j].string]);
+        }
+        else {
+            if (values[j].type == Type::FORMULA){
+                formulas.insert(values[j].formula);
+            }
+            newRow.values[j] = values[j];
         }
 
-        std::cout << std::endl;
+        if (valueColumns[j] < MASK_COLUMNS){
+            newRow.occupied |= uint64_t(1) << valueColumns[j];
+        }
+        else if (newRow.wideCount++ == 0){
+            newRow.wideColumns = arena.allocateArray<uint32_t>(count - j);
+        }
+    }
+    if (newRow.wideCount){
+        std::copy(valueColumns + count - newRow.wideCount, valueColumns + count, newRow.wideColumns);
+    }
+    storeRow(rowNum, newRow);
+
+    //updating the dependency graph and the widths
+    Row& stored = *findRow(rowNum);
+    for (size_t k=0; k<count; ++k){
+        size_t j = valueColumns[k];
+        uint32_t width = widths ? widths[k] : 0;
+        const CellValue& value = stored.values[k];
+        columnWidths[j].add(width ? width : uint32_t(widthOf(value)));
+        size_t key = address(j, rowNum);
+        if (value.type == Type::FORMULA){
+            addDependencies(key, value.formula);
+            toRecalculate.push_back(key);
+        }
+        markDependentsDirty(key);
     }
 }
 
 
 
-void Table::addRow (const std::string& row)
+void Table::setValue(char col, size_t row, std::string& newValue)
 {
-    std::vector <Cell*> newRow;
-    size_t read = 0;
-    
-    for (read; read<row.size(); ++read){
+    size_t column = size_t (col - 'A');
+    if (column >= MASK_COLUMNS){
+        throw std::invalid_argument("Invalid cell!");
+    }
+
+    CellValue number;
+    int newType = !newValue.empty() && newValue[0] == '=' ? whatIsThis(newValue) : parseValue(newValue, number);
+    if (newType == 0){
+        throw std::invalid_argument("Error: incorrect value " + newValue);
+    }
+    if ((newType == 2 || newType == 3) && number.type == Type::EMPTY){
+        throw std::invalid_argument("Number too Big!");
+    }
         
-        std::string value;
-        while (row[read] == ' ' && read<row.size()) ++read;
+    //empty rows and columns are not stored, only the table limits are changed
+    if (row > rowCount){
+        rowCount = row;
+    }
+
+    if (longestRow <= column){
+        longestRow = column+1;
+        columnWidths.resize(longestRow);
+    }
+
+    CellValue newCell;
+    switch (newType){
+        case 1: newCell = addString(newValue); break;
+
+        case 2: case 3: newCell = number; break;
 
-        while (row[read] != ',' && read<row.size()) {
-            value.push_back(row[read]);
-            ++read;
+        case 5: newCell = addFormula(newValue); break;
+        
+        default: throw std::runtime_error("Unexpected error occured!");
+    }
+
+    size_t key = address(column, row);
+    CellValue& cell = insert(column, row);
+    if (cell.type == Type::FORMULA){
+        removeDependencies(key, cell.formula);
+    }
+
+    columnWidths[column].change(uint32_t(widthOf(cell)), uint32_t(widthOf(newCell)));
+    release(cell);
+    cell = newCell;
+
+    if (newType == 5){
+        addDependencies(key, newCell.formula);
+        toRecalculate.push_back(key);
+    }
+    markDependentsDirty(key);
+    recalculate();
+}
+
+
+
+void Table::recalculate()
+{
+    if (recalculating || toRecalculate.empty()){
+        return;
+    }
+    try {
+        recalculate(toRecalculate);
+    } catch (...){
+        toRecalculate.clear();
+        throw;
+    }
+    toRecalculate.clear();
+}
+
+
+
+void Table::recalculate(const std::vector<size_t>& roots)
+{
+    if (recalculating){
+        return;
+    }
+    recalculating = true;
+
+    //the flag is reset even if a lazily read row throws, so the table can be recalculated again.
+    //The formulas not calculated yet stay dirty and are calculated when they are used
+    try {
+        //Tarjan's algorithm without recursion, on the graph of the dirty formulas
+        struct Visit {
+            size_t index;
+            size_t lowlink;
+            bool onStack;
+        };
+
+        struct Frame {
+            size_t key;
+            std::vector <size_t> references;
+            size_t next;
+        };
+
+        std::unordered_map <size_t, Visit> visits;
+        std::vector <size_t> components; //the stack of Tarjan's algorithm
+        std::vector <Frame> frames;      //replaces the recursion
+        size_t counter = 0;
+
+        //roots may grow while it is used, when rows of a lazily read table are read
+        for (size_t i=0; i<roots.size(); ++i){
+            size_t rootKey = roots[i];
+            formulaCell* root = formulaAt(rootKey);
+            if (!root || !root->isDirty() || visits.count(rootKey)){
+                continue;
+            }
+
+            visits[rootKey] = {counter, counter, true};
+            ++counter;
+            components.push_back(rootKey);
+            frames.push_back({rootKey, referencesOf(root), 0});
+
+            while (!frames.empty()){
+                Frame& frame = frames.back();
+
+                if (frame.next < frame.references.size()){
+                    size_t key = frame.references[frame.next++];
+                    formulaCell* formula = formulaAt(key);
+                    if (!formula || !formula->isDirty()){
+                        continue; //clean cells cannot be part of a new cycle
+                    }
+
+                    auto found = visits.find(key);
+                    if (found == visits.end()){
+                        visits[key] = {counter, counter, true};
+                        ++counter;
+                        components.push_back(key);
+                        frames.push_back({key, referencesOf(formula), 0}); //invalidates frame
+                    }
+                    else if (found->second.onStack){
+                        Visit& current = visits[frame.key];
+                        current.lowlink = std::min(current.lowlink, found->second.index);
+                    }
+                    continue;
+                }
+
+                size_t key = frame.key;
+                bool selfReference = std::binary_search(frame.references.begin(), frame.references.end(), key);
+                Visit visit = visits[key];
+                frames.pop_back();
+
+                if (!frames.empty()){
+                    Visit& parent = visits[frames.back().key];
+                    parent.lowlink = std::min(parent.lowlink, visit.lowlink);
+                }
+
+                if (visit.lowlink != visit.index){
+                    continue;
+                }
+
+                //key is the root of a component, all formulas it depends on are already calculated
+                if (components.back() == key && !selfReference){
+                    components.pop_back();
+                    visits[key].onStack = false;
+                    formulaCell* formula = formulaAt(key);
+                    size_t width = formula->getWidth();
+                    formula->refresh();
+                    columnWidths[key % MAX_COLUMNS].change(uint32_t(width), uint32_t(formula->getWidth()));
+                    continue;
+                }
+
+                size_t member;
+                do {
+                    member = components.back();
+                    components.pop_back();
+                    visits[member].onStack = false;
+                    formulaCell* formula = formulaAt(member);
+                    size_t width = formula->getWidth();
+                    formula->markFailed();
+                    columnWidths[member % MAX_COLUMNS].change(uint32_t(width), uint32_t(formula->getWidth()));
+                } while (member != key);
+            }
         }
+    } catch (...){
+        recalculating = false;
+        throw;
+    }
+
+    recalculating = false;
+}
 
-        while (value.size() > 0 && value.back() == ' '){
-            value.pop_back();
+
+
+Cell* Table::getCell (char col, size_t row)
+{
+    size_t column = size_t (col - 'A');
+
+    if (row > rowCount){
+        return nullptr;
+    }
+
+    //the number of columns is known after the row is read
+    const CellValue* value = find(column, row);
+    if (column >= longestRow){
+        return nullptr;
+    }
+
+    switch (value ? value->type : Type::EMPTY){
+        case Type::INT: view.reset(new intCell(value->integer)); break;
+
+        case Type::DOUBLE: view.reset(new doubleCell(value->number)); break;
+
+        case Type::STRING: view.reset(new stringCell(getS_Value(*value))); break;
+
+        case Type::FORMULA: return value->formula;
+
+        default: view.reset(new emptyCell); break;
+    }
+    return view.get();
+}
+
+
+
+double Table::getNum_Value (size_t column, size_t row)
+{
+    const CellValue* value = find(column, row);
+    if (!value){
+        return 0.0;
+    }
+
+    switch (value->type){
+        case Type::INT: return double(value->integer);
+
+        case Type::DOUBLE: return value->number;
+
+        case Type::STRING: return strings[value->string].num_value;
+
+        case Type::FORMULA: return value->formula->getNum_Value();
+
+        default: return 0.0;
+    }
+}
+
+
+
+void Table::readFromFile (std::ifstream& file)
+{
+    while (!file.eof()){
+        std::string row;
+        getline (file, row);
+        addRow(row);
+    }
+}
+
+
+
+void Table::readFromBuffer (std::string_view data, size_t threads)
+{
+    if (threads == 0){
+        threads = data.size() < PARALLEL_SIZE ? 1 : std::thread::hardware_concurrency();
+    }
+    if (threads < 2){
+        forEachLine(data, [this](std::string_view line){ addRow(line); });
+        return;
+    }
+
+    //splitting at new lines, a few chunks per thread so the threads finish at about the same time
+    std::vector <ParsedChunk> chunks;
+    size_t parts = threads * 4;
+    size_t begin = 0;
+    for (size_t i=1; i<parts; ++i){
+        size_t target = data.size() / parts * i;
+        if (target < begin){
+            continue;
+        }
+        size_t end = data.find('\n', target);
+        if (end == std::string_view::npos){
+            break;
         }
+        chunks.emplace_back();
+        chunks.back().data = data.substr(begin, end - begin);
+        begin = end + 1;
+    }
+    chunks.emplace_back();
+    chunks.back().data = data.substr(begin);
+
+    //parsing
+    std::atomic <size_t> next(0);
+    auto work = [this, &chunks, &next](){
+        for (size_t i = next++; i < chunks.size(); i = next++){
+            parseChunk(chunks[i]);
+        }
+    };
 
-        int type = whatIsThis(value);
+    std::vector <std::thread> workers;
+    for (size_t i=1; i<threads && i<chunks.size(); ++i){
+        workers.emplace_back(work);
+    }
+    work();
+    for (size_t i=0; i<workers.size(); ++i){
+        workers[i].join();
+    }
 
-        //Error cell
-        if (type == 0){
-            size_t ErrorRow = cells.size() + 1;
-            size_t ErrorCol = newRow.size() + 1;
-            std::string errMes("Error: row "); //Error Message
-            errMes += std::to_string(ErrorRow) + ", col " + std::to_string(ErrorCol) + ", " + value + " is unknown data type"; 
-            throw std::invalid_argument(errMes);
+    //merging in the original order
+    for (size_t i=0; i<chunks.size(); ++i){
+        if (chunks[i].failed){
+            //the formulas of the chunks which are not merged are not part of the table
+            for (size_t k=i+1; k<chunks.size(); ++k){
+                discard(chunks[k]);
+            }
         }
+        placeChunk(chunks[i], rowCount + 1);
+    }
+}
 
-        
-        //string
-        else if (type == 1){
-            Cell* newPtr = new stringCell(value);
-            newRow.push_back(newPtr);
+
+
+void Table::readRows()
+{
+    if (!source){
+        return;
+    }
+
+    std::vector <size_t> unread;
+    for (size_t i=0; i<blockOffsets.size(); ++i){
+        if (!blockRead[i]){
+            unread.push_back(i);
         }
+    }
 
-        //integer
-        else if (type == 2){
-            if (value[0] == '+'){
-                value.erase(value.begin()); //delete the + symbol
-            }
+    //the blocks are parsed like the chunks of readFromBuffer()
+    std::string_view data = source->getData();
+    std::vector <ParsedChunk> chunks(unread.size());
+    for (size_t i=0; i<unread.size(); ++i){
+        chunks[i].data = blockData(unread[i]);
+    }
+
+    size_t threads = data.size() < PARALLEL_SIZE ? 1 : std::thread::hardware_concurrency();
+    std::atomic <size_t> next(0);
+    auto work = [this, &chunks, &next](){
+        for (size_t i = next++; i < chunks.size(); i = next++){
+            parseChunk(chunks[i]);
+        }
+    };
 
-            try {
-                Cell* newPtr = new intCell(stoi(value));
-                newRow.push_back(newPtr);
-            } catch(const std::exception& e){
-                throw std::invalid_argument("Number too Big!");
+    std::vector <std::thread> workers;
+    for (size_t i=1; i<threads && i<chunks.size(); ++i){
+        workers.emplace_back(work);
+    }
+    work();
+    for (size_t i=0; i<workers.size(); ++i){
+        workers[i].join();
+    }
+
+    for (size_t i=0; i<chunks.size(); ++i){
+        if (chunks[i].failed){
+            for (size_t k=i+1; k<chunks.size(); ++k){
+                discard(chunks[k]);
             }
-            
         }
+        else {
+            blockRead[unread[i]] = true;
+        }
+        placeChunk(chunks[i], unread[i] * BLOCK_ROWS + 1);
+    }
+
+    source.reset();
+    blockOffsets.clear();
+    blockRead.clear();
+}
+
+
+
+void Table::readBlock(size_t block)
+{
+    ParsedChunk chunk;
+    chunk.data = blockData(block);
+    parseChunk(chunk);
+
+    //marked before storing, because storing looks up other rows
+    if (!chunk.failed){
+        blockRead[block] = true;
+    }
+    placeChunk(chunk, block * BLOCK_ROWS + 1);
+}
+
+
+
+std::string_view Table::blockData(size_t block) const
+{
+    std::string_view data = source->getData();
+    size_t end = block + 1 < blockOffsets.size() ? blockOffsets[block + 1] - 1 : data.size();
+    return data.substr(blockOffsets[block], end - blockOffsets[block]);
+}
+
+
+
+void Table::parseChunk(ParsedChunk& chunk) const
+{
+    ParsedRow parsed;
+    forEachLine(chunk.data, [this, &chunk, &parsed](std::string_view line){
+        if (chunk.failed){
+            return;
+        }
+        try {
+            parseRow(line, 0, parsed);
+        } catch (...){
+            //the row is parsed again by placeChunk(), to throw with the right row number
+            chunk.failed = true;
+            chunk.failedLine = line;
+            return;
+        }
+        chunk.rows.push_back({uint32_t(parsed.values.size()), uint32_t(parsed.texts.size()), parsed.columns});
+        chunk.values.insert(chunk.values.end(), parsed.values.begin(), parsed.values.end());
+        chunk.valueColumns.insert(chunk.valueColumns.end(), parsed.valueColumns.begin(), parsed.valueColumns.end());
+
+        //formatting the numbers to measure them is the slow part of placing them, so it is done here
+        for (size_t j=0; j<parsed.values.size(); ++j){
+            const CellValue& value = parsed.values[j];
+            bool number = value.type == Type::INT || value.type == Type::DOUBLE;
+            chunk.widths.push_back(number ? uint32_t(widthOf(value)) : 0);
+        }
+        chunk.texts.insert(chunk.texts.end(), parsed.texts.begin(), parsed.texts.end());
+    });
+}
+
+
+
+void Table::placeChunk(const ParsedChunk& chunk, size_t firstRow)
+{
+    if (chunk.failed){
+        discard(chunk);
+        ParsedRow parsed;
+        parseRow(chunk.failedLine, firstRow + chunk.rows.size(), parsed);
+        throw std::runtime_error("Unexpected error occured!");
+    }
+
+    size_t value = 0, text = 0;
+    for (size_t j=0; j<chunk.rows.size(); ++j){
+        const ParsedChunk::RowInfo& row = chunk.rows[j];
+        placeRow(firstRow + j, chunk.values.data() + value, chunk.valueColumns.data() + value, row.count, row.columns, chunk.texts.data() + text, chunk.widths.data() + value);
+        value += row.count;
+        text += row.textCount;
+    }
+}
+
+
+
+void Table::discard(const ParsedChunk& chunk)
+{
+    for (size_t j=0; j<chunk.values.size(); ++j){
+        if (chunk.values[j].type == Type::FORMULA){
+            delete chunk.values[j].formula;
+        }
+    }
+}
+
+
+
+std::unique_ptr<Table> Table::snapshot()
+{
+    readRows();
+
+    std::unique_ptr<Table> copy(new Table());
+    copy->rowCount = rowCount;
+    copy->longestRow = longestRow;
+    copy->toRecalculate = toRecalculate;
+    copy->columnWidths = columnWidths;
+
+    //the strings keep their indexes, so the string values need no change
+    size_t total = 0;
+    for (size_t i=0; i<strings.size(); ++i){
+        total += strings[i].size;
+    }
+    char* bytes = static_cast<char*>(copy->arena.allocate(total, 1));
+    copy->strings.reserve(strings.size());
+    for (size_t i=0; i<strings.size(); ++i){
+        StoredString stored = strings[i];
+        std::copy(stored.value, stored.value + stored.size, bytes);
+        stored.value = bytes;
+        bytes += stored.size;
+        copy->strings.push_back(stored);
+    }
+    copy->freeStrings = freeStrings;
+
+    copy->blocks.resize(blocks.size(), nullptr);
+    for (size_t i=0; i<blocks.size(); ++i){
+        if (!blocks[i]){
+            continue;
+        }
+        copy->blocks[i] = new (copy->arena.allocate(sizeof(RowBlock), alignof(RowBlock))) RowBlock();
 
-        //double
-        else if (type == 3){ 
-            if (value[0] == '+'){
-                value.erase(value.begin()); //delete the + symbol
+        for (size_t j=0; j<BLOCK_ROWS; ++j){
+            const Row& row = blocks[i]->rows[j];
+            if (!row.occupied && !row.wideCount){
+                continue;
             }
 
-            try {
-                Cell* newPtr = new doubleCell(stod(value));
-                newRow.push_back(newPtr);
-            } catch (const std::exception& e){
-                throw std::invalid_argument("Number too Big!");
+            Row& newRow = copy->blocks[i]->rows[j];
+            newRow.occupied = row.occupied;
+            newRow.wideCount = row.wideCount;
+            newRow.capacity = uint32_t(std::bitset<64>(row.occupied).count()) + row.wideCount;
+            newRow.values = copy->arena.allocateArray<CellValue>(newRow.capacity);
+            std::copy(row.values, row.values + newRow.capacity, newRow.values);
+            if (row.wideCount){
+                newRow.wideColumns = copy->arena.allocateArray<uint32_t>(row.wideCount);
+                std::copy(row.wideColumns, row.wideColumns + row.wideCount, newRow.wideColumns);
             }
-            
+
+            for (size_t k=0; k<newRow.capacity; ++k){
+                if (newRow.values[k].type == Type::FORMULA){
+                    formulaCell* formula = new formulaCell(*row.values[k].formula, copy.get());
+                    copy->formulas.insert(formula);
+                    newRow.values[k].formula = formula;
+                }
+            }
+        }
+    }
+
+    return copy;
+}
+
+
+
+void Table::saveInFile (std::ofstream& file, bool compressed)
+{
+    //only the text of the formulas is saved, so nothing is calculated
+    readRows();
+    FileWriter writer(file, compressed);
+    char number[doubleCell::FORMAT_SIZE];
+
+    for (size_t i=0; i<rowCount; ++i){
+        Row* row = findRow(i+1);
+
+        for (size_t j=0; j<longestRow; ++j){
+            const CellValue* found = row ? cellOf(*row, j) : nullptr;
+            if (found){
+                const CellValue& value = *found;
+                switch (value.type){
+                    case Type::INT:
+                        writer.putBytes(number, std::to_chars(number, number + sizeof(number), value.integer).ptr - number);
+                        break;
+
+                    case Type::DOUBLE:
+                        writer.putBytes(number, doubleCell::format(value.number, number));
+                        break;
+
+                    case Type::STRING: {
+                        //escaping " and \ again
+                        const StoredString& stored = strings[value.string];
+                        writer.putChar('"');
+                        for (size_t l=0; l<stored.size; ++l){
+                            if (stored.value[l] == '"' || stored.value[l] == '\\'){
+                                writer.putChar('\\');
+                            }
+                            writer.putChar(stored.value[l]);
+                        }
+                        writer.putChar('"');
+                        break;
+                    }
+
+                    case Type::FORMULA: {
+                        const std::string& expression = value.formula->getValue();
+                        writer.putBytes(expression.data(), expression.size());
+                        break;
+                    }
+
+                    default: break;
+                }
+            }
+            if (j+1 < longestRow){
+                writer.putChar(',');
+            }
+        }
+        if (i+1<rowCount){
+            writer.putChar('\n');
         }
+    }
+    
+}
 
-        //empty
-        else if (type == 4){ 
-            Cell* newPtr = new emptyCell;
-            newRow.push_back(newPtr);
+
+
+void Table::saveBinary (std::ofstream& file, bool compressed)
+{
+    readRows();
+    recalculate();
+
+    FileWriter writer(file, compressed);
+    writer.putBytes(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    writer.put<uint32_t>(BINARY_VERSION);
+    writer.put<uint32_t>(uint32_t(longestRow));
+    writer.put<uint64_t>(rowCount);
+
+    //only the strings of the stored cells are written, numbered in the order they are first used
+    std::vector <uint32_t> savedIndex(strings.size(), UINT32_MAX);
+    std::vector <uint32_t> saved;
+    for (size_t i=0; i<blocks.size(); ++i){
+        if (!blocks[i]){
+            continue;
         }
+        for (size_t j=0; j<BLOCK_ROWS; ++j){
+            const Row& row = blocks[i]->rows[j];
+            size_t count = std::bitset<64>(row.occupied).count() + row.wideCount;
+            for (size_t k=0; k<count; ++k){
+                const CellValue& value = row.values[k];
+                if (value.type == Type::STRING && savedIndex[value.string] == UINT32_MAX){
+                    savedIndex[value.string] = uint32_t(saved.size());
+                    saved.push_back(value.string);
+                }
+            }
+        }
+    }
+
+    writer.put<uint64_t>(saved.size());
+    for (size_t i=0; i<saved.size(); ++i){
+        writer.put<uint32_t>(strings[saved[i]].size);
+        writer.putBytes(strings[saved[i]].value, strings[saved[i]].size);
+    }
 
-        //formula
-        else { //type == 5
-            Cell* newPtr = new formulaCell(value, this);
-            newRow.push_back(newPtr);
+    //the stored rows, each one followed by its values. Row 0 ends the list
+    for (size_t i=0; i<blocks.size(); ++i){
+        if (!blocks[i]){
+            continue;
         }
+        for (size_t j=0; j<BLOCK_ROWS; ++j){
+            const Row& row = blocks[i]->rows[j];
+            if (!row.occupied && !row.wideCount){
+                continue;
+            }
+            writer.put<uint64_t>(i * BLOCK_ROWS + j + 1);
+            writer.put<uint64_t>(row.occupied);
+            writer.put<uint32_t>(row.wideCount);
+            for (size_t k=0; k<row.wideCount; ++k){
+                writer.put<uint32_t>(row.wideColumns[k]);
+            }
 
-    }
+            size_t count = std::bitset<64>(row.occupied).count() + row.wideCount;
+            for (size_t k=0; k<count; ++k){
+                const CellValue& value = row.values[k];
+                writer.put<uint8_t>(uint8_t(value.type));
+                switch (value.type){
+                    case Type::INT: writer.put<int32_t>(value.integer); break;
+
+                    case Type::DOUBLE: writer.put<double>(value.number); break;
+
+                    case Type::STRING: writer.put<uint32_t>(savedIndex[value.string]); break;
+
+                    case Type::FORMULA: {
+                        const formulaCell* formula = value.formula;
+                        std::string text = formula->getS_Value();
+                        writer.put<uint32_t>(uint32_t(text.size()));
+                        writer.putBytes(text.data(), text.size());
+                        writer.put<uint8_t>(uint8_t(formula->isCompiled()) | uint8_t(formula->isFailed()) << 1);
+                        writer.put<double>(formula->isFailed() ? 0.0 : value.formula->getNum_Value());
+
+                        const std::vector<Instruction>& program = formula->getProgram();
+                        writer.put<uint32_t>(uint32_t(program.size()));
+                        for (size_t l=0; l<program.size(); ++l){
+                            writer.put<uint8_t>(uint8_t(program[l].kind));
+                            writer.put<char>(program[l].op);
+                            writer.put<char>(program[l].col);
+                            writer.put<uint64_t>(program[l].row);
+                            writer.put<double>(program[l].number);
+                        }
+                        break;
+                    }
 
-    if (newRow.size() > longestRow){
-        longestRow = newRow.size();
+                    default: break;
+                }
+            }
+        }
     }
-
-    cells.push_back(newRow);
+    writer.put<uint64_t>(0);
 }
 
 
 
-void Table::setValue(char col, size_t row, std::string& newValue)
+void Table::readBinary (std::string_view data)
 {
-    size_t column = size_t (col - 'A');
-
-    int newType = whatIsThis(newValue);
-    if (newType == 0){
-        throw std::invalid_argument("Error: incorrect value " + newValue);
+    BinaryReader reader(data);
+    if (reader.getBytes(sizeof(BINARY_MAGIC)) != std::string_view(BINARY_MAGIC, sizeof(BINARY_MAGIC))){
+        throw std::invalid_argument("Error: the file is damaged");
     }
-        
-    //adding empty rows if necessary
-    while (row > cells.size()){
-        addRow("");
+    if (reader.get<uint32_t>() != BINARY_VERSION){
+        throw std::invalid_argument("Error: unsupported version of the binary format");
     }
 
-    //adding empty columns if necessary
-    while (column >= cells[row-1].size()){
-        Cell* empty_Cell = new emptyCell;
-        cells[row-1].push_back(empty_Cell);
+    longestRow = reader.get<uint32_t>();
+    rowCount = reader.get<uint64_t>();
+    if (longestRow > MAX_COLUMNS){
+        throw std::invalid_argument("Error: the file is damaged");
     }
-
-    if (longestRow <= column){
-        longestRow = column+1;
+    columnWidths.resize(longestRow);
+
+    //the indexes in the file may differ from the indexes in the pool.
+    //Every string of the file is referenced once until the cells are read
+    std::vector <uint32_t> stringIndexes(reader.get<uint64_t>());
+    for (size_t i=0; i<stringIndexes.size(); ++i){
+        uint32_t size = reader.get<uint32_t>();
+        stringIndexes[i] = internString(reader.getBytes(size));
     }
 
-    Cell* newCell;
-    switch (newType){
-        case 1: newCell = new stringCell(newValue); break;
+    size_t lastRow = 0;
+    for (size_t rowNum = reader.get<uint64_t>(); rowNum != 0; rowNum = reader.get<uint64_t>()){
+        Row row;
+        row.occupied = reader.get<uint64_t>();
+        row.wideCount = reader.get<uint32_t>();
+        if (rowNum <= lastRow || rowNum > rowCount || (row.occupied == 0 && row.wideCount == 0) ||
+            (longestRow < MASK_COLUMNS && row.occupied >> longestRow) || row.wideCount > longestRow){
+            throw std::invalid_argument("Error: the file is damaged");
+        }
+        lastRow = rowNum;
+
+        //the wide columns follow each other after MASK_COLUMNS, up to the longest row
+        if (row.wideCount){
+            row.wideColumns = arena.allocateArray<uint32_t>(row.wideCount);
+            for (size_t k=0; k<row.wideCount; ++k){
+                row.wideColumns[k] = reader.get<uint32_t>();
+                if (row.wideColumns[k] < (k ? row.wideColumns[k-1] + 1 : MASK_COLUMNS) || row.wideColumns[k] >= longestRow){
+                    throw std::invalid_argument("Error: the file is damaged");
+                }
+            }
+        }
 
-        case 2: newCell = new intCell(std::stoi(newValue)); break;
-        
-        case 3: newCell = new doubleCell(std::stod(newValue)); break;
+        size_t maskCount = std::bitset<64>(row.occupied).count();
+        row.capacity = uint32_t(maskCount) + row.wideCount;
+        row.values = arena.allocateArray<CellValue>(row.capacity);
+        std::fill(row.values, row.values + row.capacity, CellValue());
+        storeRow(rowNum, row);
+
+        uint64_t rest = row.occupied;
+        for (size_t k=0; k<row.capacity; ++k){
+            size_t col;
+            if (k < maskCount){
+                col = Scanner::lowestBit(rest);
+                rest &= rest - 1;
+            }
+            else {
+                col = row.wideColumns[k - maskCount];
+            }
 
-        case 5: newCell = new formulaCell(newValue, this); break;
-        
-        default: throw std::runtime_error("Unexpected error occured!");
+            CellValue& value = row.values[k];
+            switch (Type(reader.get<uint8_t>())){
+                case Type::INT: value = CellValue(int(reader.get<int32_t>())); break;
+
+                case Type::DOUBLE: value = CellValue(reader.get<double>()); break;
+
+                case Type::STRING: {
+                    uint32_t index = reader.get<uint32_t>();
+                    if (index >= stringIndexes.size()){
+                        throw std::invalid_argument("Error: the file is damaged");
+                    }
+                    value = CellValue::ofString(stringIndexes[index]);
+                    ++strings[stringIndexes[index]].references;
+                    break;
+                }
+
+                case Type::FORMULA: {
+                    uint32_t size = reader.get<uint32_t>();
+                    std::string text(reader.getBytes(size));
+                    uint8_t flags = reader.get<uint8_t>();
+                    double result = reader.get<double>();
+
+                    //the program is executed as it is, so it must leave exactly one number on the stack
+                    std::vector <Instruction> program(reader.get<uint32_t>());
+                    size_t depth = 0;
+                    for (size_t l=0; l<program.size(); ++l){
+                        uint8_t kind = reader.get<uint8_t>();
+                        program[l].op = reader.get<char>();
+                        program[l].col = reader.get<char>();
+                        program[l].row = reader.get<uint64_t>();
+                        program[l].number = reader.get<double>();
+                        program[l].kind = Instruction::Kind(kind);
+
+                        bool valid;
+                        switch (program[l].kind){
+                            case Instruction::Kind::NUMBER: valid = true; ++depth; break;
+                            case Instruction::Kind::REFERENCE: valid = program[l].col >= 'A' && program[l].col <= 'Z' && program[l].row != 0; ++depth; break;
+                            case Instruction::Kind::NEGATE: valid = depth >= 1; break;
+                            case Instruction::Kind::OPERATOR: valid = depth >= 2 && formulaCell::isOperator(program[l].op); --depth; break;
+                            default: valid = false;
+                        }
+                        if (!valid){
+                            throw std::invalid_argument("Error: the file is damaged");
+                        }
+                    }
+                    if ((flags & 1) && depth != 1){
+                        throw std::invalid_argument("Error: the file is damaged");
+                    }
+
+                    //the formula is compiled and calculated already
+                    formulaCell* formula = new formulaCell(text, this, std::move(program), flags & 1, result, flags & 2);
+                    formulas.insert(formula);
+                    value = CellValue(formula);
+                    addDependencies(address(col, rowNum), formula);
+                    break;
+                }
+
+                default: throw std::invalid_argument("Error: the file is damaged");
+            }
+            columnWidths[col].add(uint32_t(widthOf(value)));
+        }
     }
 
-    delete cells[row-1][column];
-    cells[row-1][column] = newCell;
+    //the strings of the file which no cell has are freed
+    for (size_t i=0; i<stringIndexes.size(); ++i){
+        releaseString(stringIndexes[i]);
+    }
 }
 
 
 
-Cell** Table::getCell (char col, size_t row)
+void Table::readData (std::string_view data)
 {
-    size_t column = size_t (col - 'A');
-
-    if (row > cells.size() || column >= cells[row-1].size()){
-        return nullptr;
+    if (BlockCodec::isCompressed(data)){
+        //the table copies what it needs, so the decompressed data is freed afterwards
+        std::string decompressed = BlockCodec::decompressFile(data);
+        if (isBinary(decompressed)){
+            readBinary(decompressed);
+        }
+        else {
+            readFromBuffer(decompressed);
+        }
+    }
+    else if (isBinary(data)){
+        readBinary(data);
+    }
+    else {
+        readFromBuffer(data);
     }
-    
-    return &cells[row-1][column];
 }
 
 
 
-void Table::readFromFile (std::ifstream& file)
+bool Table::isBinary (std::string_view data)
 {
-    while (!file.eof()){
-        std::string row;
-        getline (file, row);
-        addRow(row);
-    }
+    return data.substr(0, sizeof(BINARY_MAGIC)) == std::string_view(BINARY_MAGIC, sizeof(BINARY_MAGIC));
 }
 
 
 
-void Table::saveInFile (std::ofstream& file)
+int Table::whatIsThis (std::string& str)
 {
-    align();
-    for (size_t i=0; i<cells.size(); ++i){
-        std::string rowValue;
-        for (size_t j=0; j<cells[i].size(); ++j){
-            rowValue += cells[i][j]->getS_Value();
-            if (j+1 < cells[i].size()){
-                rowValue.push_back(',');
-            }
-        }
-        file << rowValue;
-        if (i+1<cells.size()){
-            file << "\n";
-        }
+    if (str.size() > 0 && str[0] == '='){
+        return isFormula(str) ? 5 : 0;
     }
-    
+
+    return typeOf(str);
 }
 
 
 
-int Table::whatIsThis (std::string& str)
+int Table::typeOf (std::string_view str)
 {
     if (str.size() == 0){
         return 4;
     }
 
     if (str[0] == '='){
-        return isFormula(str) ? 5 : 0;
+        return 0;
     }
 
 
@@ -354,6 +1493,72 @@ int Table::whatIsThis (std::string& str)
 
 
 
+int Table::parseValue (std::string_view str, CellValue& number)
+{
+    number = CellValue();
+    const char* first = str.data();
+    const char* last = first + str.size();
+
+    //the usual numbers, [+-]digits[.digits], are checked while they are converted
+    const char* digits = first + (str.size() > 0 && (*first == '+' || *first == '-'));
+    if (digits < last && *digits >= '0' && *digits <= '9'){
+        const char* begin = first + (*first == '+'); //std::from_chars does not accept the + symbol
+
+        int integer;
+        std::from_chars_result result = std::from_chars(begin, last, integer);
+        if (result.ptr == last){
+            if (result.ec == std::errc()){
+                number = CellValue(integer);
+            }
+            return 2;
+        }
+
+        if (*result.ptr != '.'){
+            return 0;
+        }
+
+        //the integer part is valid, at least one digit and nothing else must follow the point
+        const char* read = result.ptr + 1;
+        if (read == last){
+            return 0;
+        }
+        while (read < last && *read >= '0' && *read <= '9') ++read;
+        if (read != last){
+            return 0;
+        }
+
+        double real;
+        result = std::from_chars(begin, last, real);
+        if (result.ec == std::errc()){
+            number = CellValue(real);
+        }
+        return 3;
+    }
+
+    //the rest is classified as before. The first symbol of a number is not checked,
+    //std::stoi and std::stod used to skip it if it was a white space
+    int type = typeOf(str);
+    if ((type == 2 || type == 3) && std::isspace(static_cast<unsigned char>(*first))){
+        ++first;
+        if (type == 2){
+            int integer;
+            if (std::from_chars(first, last, integer).ec == std::errc()){
+                number = CellValue(integer);
+            }
+        }
+        else {
+            double real;
+            std::from_chars_result result = std::from_chars(first, last, real);
+            if (result.ec == std::errc() && result.ptr == last){
+                number = CellValue(real);
+            }
+        }
+    }
+    return type;
+}
+
+
+
 bool Table::isFormula(std::string& str)
 {
         //deleting empty spaces and to upper case
@@ -426,3 +1631,345 @@ bool Table::isFormula(std::string& str)
 
         return !lastSign;
 }
+
+
+
+size_t Table::address(size_t column, size_t row)
+{
+    return (row - 1) * MAX_COLUMNS + column;
+}
+
+
+
+formulaCell* Table::formulaAt(size_t key)
+{
+    CellValue* value = find(key % MAX_COLUMNS, key / MAX_COLUMNS + 1);
+    if (!value || value->type != Type::FORMULA){
+        return nullptr;
+    }
+    return value->formula;
+}
+
+
+
+std::vector<size_t> Table::referencesOf(const formulaCell* formula)
+{
+    std::vector <size_t> keys;
+    const std::vector<Instruction>& program = formula->getProgram();
+    for (size_t i=0; i<program.size(); ++i){
+        if (program[i].kind == Instruction::Kind::REFERENCE){
+            keys.push_back(address(program[i].col - 'A', program[i].row));
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+
+
+void Table::addDependencies(size_t key, const formulaCell* formula)
+{
+    std::vector <size_t> references = referencesOf(formula);
+    for (size_t i=0; i<references.size(); ++i){
+        dependents[references[i]].push_back(key);
+    }
+}
+
+
+
+void Table::removeDependencies(size_t key, const formulaCell* formula)
+{
+    std::vector <size_t> references = referencesOf(formula);
+    for (size_t i=0; i<references.size(); ++i){
+        auto found = dependents.find(references[i]);
+        if (found == dependents.end()){
+            continue;
+        }
+
+        std::vector <size_t>& edges = found->second;
+        auto edge = std::find(edges.begin(), edges.end(), key);
+        if (edge != edges.end()){
+            *edge = edges.back();
+            edges.pop_back();
+        }
+        if (edges.empty()){
+            dependents.erase(found);
+        }
+    }
+}
+
+
+
+void Table::markDependentsDirty(size_t key)
+{
+    //most cells have no dependents, nothing is allocated for them
+    if (dependents.find(key) == dependents.end()){
+        return;
+    }
+
+    std::vector <size_t> to_visit(1, key);
+    std::unordered_set <size_t> visited;
+
+    while (!to_visit.empty()){
+        auto found = dependents.find(to_visit.back());
+        to_visit.pop_back();
+        if (found == dependents.end()){
+            continue;
+        }
+
+        for (size_t i=0; i<found->second.size(); ++i){
+            size_t dependent = found->second[i];
+            if (!visited.insert(dependent).second){
+                continue;
+            }
+
+            formulaCell* formula = formulaAt(dependent);
+            if (formula){
+                if (!formula->isDirty()){
+                    formula->markDirty();
+                    toRecalculate.push_back(dependent);
+                }
+                to_visit.push_back(dependent);
+            }
+        }
+    }
+}
+
+
+
+CellValue Table::addString(std::string_view s_value)
+{
+    //Avoiding the surrounding quotations
+    std::string_view value = s_value.substr(1, s_value.size() - 2);
+
+    //only strings with escaped symbols are copied before the lookup
+    static thread_local std::string unescaped;
+    if (value.find('\\') != std::string_view::npos){
+        unescaped.clear();
+        for (size_t i=0; i<value.size(); ++i){
+            if (value[i] == '\\'){
+                ++i;
+            }
+            unescaped.push_back(value[i]);
+        }
+        value = unescaped;
+    }
+
+    return CellValue::ofString(internString(value));
+}
+
+
+
+uint32_t Table::internString(std::string_view value)
+{
+    auto found = stringIndex.find(value);
+    if (found != stringIndex.end()){
+        ++strings[found->second].references;
+        return found->second;
+    }
+
+    uint32_t index = uint32_t(strings.size());
+    if (!freeStrings.empty()){
+        index = freeStrings.back();
+        freeStrings.pop_back();
+    }
+    else {
+        strings.push_back(StoredString{nullptr, 0, 0, 0.0});
+    }
+
+    //the characters of a freed string are overwritten if the new one fits, the arena frees nothing else
+    StoredString& stored = strings[index];
+    char* copy = stored.value && value.size() <= stored.size ? const_cast<char*>(stored.value) : static_cast<char*>(arena.allocate(value.size(), 1));
+    std::copy(value.begin(), value.end(), copy);
+    stored.value = copy;
+    stored.size = uint32_t(value.size());
+    stored.references = 1;
+
+    try {
+        stored.num_value = std::stod(std::string(value));
+    } catch (std::exception& e){
+        stored.num_value = 0.0;
+    }
+
+    stringIndex.emplace(std::string_view(stored.value, stored.size), index);
+    return index;
+}
+
+
+
+void Table::releaseString(uint32_t index)
+{
+    StoredString& stored = strings[index];
+    if (--stored.references == 0){
+        stringIndex.erase(std::string_view(stored.value, stored.size));
+        freeStrings.push_back(index);
+    }
+}
+
+
+
+CellValue Table::addFormula(const std::string& value)
+{
+    formulaCell* formula = new formulaCell(value, this);
+    formulas.insert(formula);
+    return CellValue(formula);
+}
+
+
+
+Table::Row* Table::findRow(size_t row)
+{
+    size_t block = (row - 1) / BLOCK_ROWS;
+    if (source && row != 0 && block < blockOffsets.size() && !blockRead[block]){
+        readBlock(block);
+    }
+
+    if (row == 0 || block >= blocks.size() || !blocks[block]){
+        return nullptr;
+    }
+
+    Row& found = blocks[block]->rows[(row - 1) % BLOCK_ROWS];
+    return found.occupied || found.wideCount ? &found : nullptr;
+}
+
+
+
+CellValue* Table::find(size_t column, size_t row)
+{
+    Row* found = findRow(row);
+    return found ? cellOf(*found, column) : nullptr;
+}
+
+
+
+CellValue* Table::cellOf(Row& row, size_t column)
+{
+    //the position of the value is the number of non-empty cells before it
+    if (column < MASK_COLUMNS){
+        uint64_t bit = uint64_t(1) << column;
+        return (row.occupied & bit) ? &row.values[std::bitset<64>(row.occupied & (bit - 1)).count()] : nullptr;
+    }
+
+    const uint32_t* end = row.wideColumns + row.wideCount;
+    const uint32_t* found = std::lower_bound(static_cast<const uint32_t*>(row.wideColumns), end, uint32_t(column));
+    if (found == end || *found != column){
+        return nullptr;
+    }
+    return &row.values[std::bitset<64>(row.occupied).count() + size_t(found - row.wideColumns)];
+}
+
+
+
+void Table::storeRow(size_t row, const Row& newRow)
+{
+    size_t block = (row - 1) / BLOCK_ROWS;
+    if (block >= blocks.size()){
+        blocks.resize(block + 1, nullptr);
+    }
+    if (!blocks[block]){
+        blocks[block] = new (arena.allocate(sizeof(RowBlock), alignof(RowBlock))) RowBlock();
+    }
+    blocks[block]->rows[(row - 1) % BLOCK_ROWS] = newRow;
+}
+
+
+
+CellValue& Table::insert(size_t column, size_t row)
+{
+    if (!findRow(row)){
+        storeRow(row, Row());
+    }
+
+    Row& found = blocks[(row - 1) / BLOCK_ROWS]->rows[(row - 1) % BLOCK_ROWS];
+    uint64_t bit = uint64_t(1) << column;
+    size_t index = std::bitset<64>(found.occupied & (bit - 1)).count();
+    if (found.occupied & bit){
+        return found.values[index];
+    }
+
+    size_t size = std::bitset<64>(found.occupied).count() + found.wideCount;
+    if (size == found.capacity){
+        //the old memory stays in the arena until the table is destroyed
+        uint32_t capacity = found.capacity ? found.capacity * 2 : 4;
+        CellValue* values = arena.allocateArray<CellValue>(capacity);
+        std::copy(found.values, found.values + size, values);
+        found.values = values;
+        found.capacity = capacity;
+    }
+
+    std::copy_backward(found.values + index, found.values + size, found.values + size + 1);
+    found.values[index] = CellValue();
+    found.occupied |= bit;
+    return found.values[index];
+}
+
+
+
+void Table::release(const CellValue& value)
+{
+    if (value.type == Type::FORMULA){
+        formulas.erase(value.formula);
+        delete value.formula;
+    }
+    else if (value.type == Type::STRING){
+        releaseString(value.string);
+    }
+}
+
+
+
+size_t Table::widthOf(const CellValue& value) const
+{
+    char number[16];
+    switch (value.type){
+        case Type::INT: return size_t(std::to_chars(number, number + sizeof(number), value.integer).ptr - number);
+
+        case Type::DOUBLE: return doubleCell::width(value.number);
+
+        case Type::STRING: return strings[value.string].size;
+
+        case Type::FORMULA: return value.formula->getWidth();
+
+        default: return 0;
+    }
+}
+
+
+
+void Table::print(const CellValue& value, std::string& out) const
+{
+    char number[doubleCell::FORMAT_SIZE];
+    switch (value.type){
+        case Type::INT: out.append(number, std::to_chars(number, number + sizeof(number), value.integer).ptr); break;
+
+        case Type::DOUBLE: out.append(number, doubleCell::format(value.number, number)); break;
+
+        case Type::STRING: out.append(strings[value.string].value, strings[value.string].size); break;
+
+        case Type::FORMULA: out += value.formula->getResult_String(); break;
+
+        default: break;
+    }
+}
+
+
+
+std::string Table::getS_Value(const CellValue& value)
+{
+    switch (value.type){
+        case Type::INT: {
+            char number[16];
+            return std::string(number, std::to_chars(number, number + sizeof(number), value.integer).ptr);
+        }
+
+        case Type::DOUBLE: return doubleCell::format(value.number);
+
+        case Type::STRING: return stringCell::escape(strings[value.string].value, strings[value.string].size);
+
+        case Type::FORMULA: return value.formula->getS_Value();
+
+        default: return std::string();
+    }
+}
@@ -0,0 +1,76 @@
+#include "../headers/widthHistogram.h"
+
+
+WidthHistogram::WidthHistogram() : widest(0)
+{}
+
+
+
+void WidthHistogram::add(uint32_t width)
+{
+    if (width == 0){
+        return;
+    }
+
+    if (width < DENSE){
+        if (width >= counts.size()){
+            counts.resize(width + 1, 0);
+        }
+        ++counts[width];
+    }
+    else {
+        ++wide[width];
+    }
+
+    if (width > widest){
+        widest = width;
+    }
+}
+
+
+
+void WidthHistogram::remove(uint32_t width)
+{
+    if (width == 0){
+        return;
+    }
+
+    if (width >= DENSE){
+        auto found = wide.find(width);
+        if (found != wide.end() && --found->second == 0){
+            wide.erase(found);
+        }
+    }
+    else if (width < counts.size() && counts[width] > 0){
+        --counts[width];
+    }
+
+    //the next width is looked for only if the last widest cell is removed
+    if (width != widest){
+        return;
+    }
+    if (!wide.empty()){
+        widest = wide.rbegin()->first;
+        return;
+    }
+    if (widest >= counts.size()){
+        widest = counts.empty() ? 0 : uint32_t(counts.size() - 1);
+    }
+    while (widest > 0 && counts[widest] == 0){
+        --widest;
+    }
+}
+
+
+
+void WidthHistogram::change(uint32_t from, uint32_t to)
+{
+    if (from != to){
+        add(to);
+        remove(from);
+    }
+}
+
+
+
+uint32_t WidthHistogram::max() const { return widest; }